@@ -0,0 +1,119 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef COMMUNICATOR_H
+#define COMMUNICATOR_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! \brief This abstract class defines the communication operations between the processors that simulate independent replicas.
+//! \details Each processor is identified by its rank within the communicator.  All operations other than getRank, getSize, getWallTime,
+//! fetchAndAddCounter, sendReceive, and abort are collective and must be called by all processors of the communicator in the same order.
+//! The sendReceive and exchangeAll operations provide the point-to-point halo exchange and carrier migration between neighboring domains
+//! that a spatial domain decomposition of a single lattice requires.
+//! The MPI_Communicator class runs each processor as an MPI process, and the Thread_Communicator class runs each processor as a thread of a single process.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Communicator {
+	public:
+		//! \brief Combines the input values into the output values, with the input values coming from the lower ranked processors.
+		typedef void(*Reduce_Function)(const double* input, double* output, const int N_values);
+
+		virtual ~Communicator() {}
+
+		//! \brief Gets the rank of this processor within the communicator.
+		virtual int getRank() const = 0;
+
+		//! \brief Gets the number of processors in the communicator.
+		virtual int getSize() const = 0;
+
+		//! \brief Gets the wall clock time in seconds since an arbitrary time in the past.
+		virtual double getWallTime() const = 0;
+
+		//! \brief Ends the whole run after an error that occured on only some of the processors.
+		virtual void abort() = 0;
+
+		//! \brief Blocks until all processors have called the function.
+		virtual void barrier() = 0;
+
+		//! \brief Copies the data of the root processor into the data of all other processors.
+		//! \param data is a buffer of size bytes on all processors.
+		virtual void broadcast(void* data, const size_t size, const int root) = 0;
+
+		//! \brief Gathers one value from each processor.
+		//! \return The values in rank order on the root processor and an empty vector on all other processors.
+		virtual std::vector<int> gather(const int value, const int root) = 0;
+
+		//! \brief Gathers one string from each processor.
+		//! \return The strings in rank order on the root processor and an empty vector on all other processors.
+		virtual std::vector<std::string> gather(const std::string& value, const int root) = 0;
+
+		//! \brief Sends the data to the dest processor and receives the data sent by the source processor, such as in a halo exchange.
+		//! \details Messages between the same pair of processors are received in the order they were sent.  The data can have any size,
+		//! and the size does not need to be known by the receiving processor.
+		//! \param dest is the rank of the processor to send to, or a negative value to send nothing.
+		//! \param source is the rank of the processor to receive from, or a negative value to receive nothing.
+		//! \return The received data, which is empty when nothing is received.
+		virtual std::vector<unsigned char> sendReceive(const std::vector<unsigned char>& data, const int dest, const int source) = 0;
+
+		//! \brief Sends a separate data vector to each processor and receives the data vectors sent to this processor, such as when migrating carriers.
+		//! \param data contains one data vector of any size for each processor in rank order, which is empty for processors that are not sent anything.
+		//! \return The received data vectors in rank order of the sending processors.
+		virtual std::vector<std::vector<unsigned char>> exchangeAll(const std::vector<std::vector<unsigned char>>& data) = 0;
+
+		//! \brief Combines the data vectors of all processors, which must have the same size, using the reduce function.
+		//! \details The data vectors are combined in rank order, so that the result does not depend on the backend.
+		//! On the root processor, the data is replaced by the combined data, and on all other processors, the data is unchanged.
+		virtual void reduce(std::vector<double>& data, Reduce_Function function, const int root) = 0;
+
+		//! \brief Starts a non-blocking sum of the count input values over all processors.
+		//! \details Only one non-blocking sum can be pending at a time, and the input and output must not be used until it has completed.
+		virtual void startSum(const int* input, int* output, const int count) = 0;
+
+		//! \brief Checks whether a non-blocking sum has been started and has not yet completed.
+		virtual bool isSumPending() const = 0;
+
+		//! \brief Checks whether the pending non-blocking sum has completed without waiting for it.
+		//! \return true if the sum has completed, in which case the output is valid and the sum is no longer pending.
+		virtual bool testSum() = 0;
+
+		//! \brief Waits for the pending non-blocking sum to complete.
+		virtual void waitSum() = 0;
+
+		//! \brief Creates a counter that is shared by all processors and is initially zero.
+		virtual void createCounter() = 0;
+
+		//! \brief Atomically adds the increment to the shared counter.
+		//! \return The value of the counter before the increment was added.
+		virtual long int fetchAndAddCounter(const long int increment) = 0;
+
+		//! \brief Resets the shared counter to zero after all processors have finished using it.
+		virtual void resetCounter() = 0;
+
+		//! \brief Frees the shared counter.
+		virtual void freeCounter() = 0;
+
+		//! \brief Splits the communicator into new communicators of the processors with the same color, which keep their relative rank order.
+		virtual std::unique_ptr<Communicator> split(const int color) = 0;
+
+		//! \brief Splits the communicator into new communicators of the processors with the same color that can also share memory.
+		virtual std::unique_ptr<Communicator> splitShared(const int color) = 0;
+
+		//! \brief Creates an array that is shared by all processors of a communicator created by splitShared.
+		//! \param size is the size of the array in bytes.
+		//! \param fill is called by the root processor to fill the array before it is made visible to the other processors.
+		//! \return A pointer to the shared array, which remains valid until the shared arrays are freed.
+		virtual const unsigned char* createSharedArray(const size_t size, const std::function<void(unsigned char*)>& fill) = 0;
+
+		//! \brief Frees all shared arrays created by this communicator.
+		virtual void freeSharedArrays() = 0;
+};
+
+#endif // COMMUNICATOR_H
@@ -0,0 +1,84 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Thread_Communicator.h"
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+mutex output_mutex;
+
+// Creates test data whose size and content identify the sending and receiving processors
+vector<unsigned char> createData(const int source, const int dest, const int round) {
+	if (dest < 0) {
+		return vector<unsigned char>();
+	}
+	return vector<unsigned char>((size_t)(source * 7 + dest * 3 + round) % 11, (unsigned char)(source * 16 + dest + round));
+}
+
+int checkData(const vector<unsigned char>& data, const int source, const int dest, const int round, const string& test_name) {
+	if (data != createData(source, dest, round)) {
+		lock_guard<mutex> lock(output_mutex);
+		cout << "Error! " << test_name << " data received by processor " << dest << " from processor " << source << " in round " << round << " is incorrect." << endl;
+		return 1;
+	}
+	return 0;
+}
+
+int runTests(Communicator& comm) {
+	int N_failures = 0;
+	const int rank = comm.getRank();
+	const int size = comm.getSize();
+	for (int round = 0; round < 5; round++) {
+		// Halo exchange between the slabs of a non-periodic lattice, where the first and last slabs have only one neighbor
+		int up = (rank < size - 1) ? rank + 1 : -1;
+		int down = (rank > 0) ? rank - 1 : -1;
+		vector<unsigned char> data = comm.sendReceive(createData(rank, up, round), up, down);
+		N_failures += (down < 0) ? (int)!data.empty() : checkData(data, down, rank, round, "Upward halo");
+		data = comm.sendReceive(createData(rank, down, round), down, up);
+		N_failures += (up < 0) ? (int)!data.empty() : checkData(data, up, rank, round, "Downward halo");
+		// Halo exchange between the slabs of a periodic lattice
+		int next = (rank + 1) % size;
+		int previous = (rank + size - 1) % size;
+		data = comm.sendReceive(createData(rank, next, round), next, previous);
+		N_failures += checkData(data, previous, rank, round, "Periodic halo");
+		// Migration of carriers to all other processors, including empty messages
+		vector<vector<unsigned char>> data_send;
+		for (int i = 0; i < size; i++) {
+			data_send.push_back(createData(rank, i, round));
+		}
+		vector<vector<unsigned char>> data_all = comm.exchangeAll(data_send);
+		for (int i = 0; i < size; i++) {
+			N_failures += checkData(data_all[i], i, rank, round, "Migration");
+		}
+	}
+	return N_failures;
+}
+
+int main() {
+	int N_failures = 0;
+	for (int N_threads = 1; N_threads <= 5; N_threads++) {
+		vector<unique_ptr<Thread_Communicator>> comms = Thread_Communicator::create(N_threads);
+		vector<int> failures(N_threads, 0);
+		vector<thread> threads;
+		for (int i = 0; i < N_threads; i++) {
+			threads.push_back(thread([&, i] { failures[i] = runTests(*comms[i]); }));
+		}
+		for (auto& item : threads) {
+			item.join();
+		}
+		for (auto item : failures) {
+			N_failures += item;
+		}
+	}
+	if (N_failures > 0) {
+		cout << N_failures << " Communicator tests failed." << endl;
+		return 1;
+	}
+	cout << "All Communicator tests passed." << endl;
+	return 0;
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "FFT.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+
+FFT_1D::FFT_1D(const int length) {
+	N = length;
+	isPowerOfTwo = (N > 0) && ((N & (N - 1)) == 0);
+	if (isPowerOfTwo) {
+		calculateRadix2Data(N, bit_reversal, twiddles);
+		return;
+	}
+	// Bluestein's algorithm expresses the length N transform as a convolution that is evaluated with power of two transforms
+	M = FFT::nextPowerOfTwo(2 * N - 1);
+	calculateRadix2Data(M, bit_reversal_M, twiddles_M);
+	const double pi = acos(-1.0);
+	chirp.resize(N);
+	for (long int n = 0; n < N; n++) {
+		// n^2 is reduced modulo 2N to preserve the precision of the phase for large n
+		double angle = pi*(double)((n*n) % (2 * (long int)N)) / (double)N;
+		chirp[n] = complex<double>(cos(angle), -sin(angle));
+	}
+	chirp_filter_fft.assign(M, complex<double>(0.0, 0.0));
+	chirp_filter_fft[0] = conj(chirp[0]);
+	for (int n = 1; n < N; n++) {
+		chirp_filter_fft[n] = conj(chirp[n]);
+		chirp_filter_fft[M - n] = conj(chirp[n]);
+	}
+	transformRadix2(chirp_filter_fft.data(), M, bit_reversal_M, twiddles_M, false);
+	work.resize(M);
+}
+
+void FFT_1D::calculateRadix2Data(const int length, vector<int>& bit_rev, vector<complex<double>>& twiddle_vec) {
+	const double pi = acos(-1.0);
+	int log2_length = 0;
+	while ((1 << log2_length) < length) {
+		log2_length++;
+	}
+	bit_rev.assign(length, 0);
+	for (int i = 0; i < length; i++) {
+		int reversed = 0;
+		for (int b = 0; b < log2_length; b++) {
+			if (i & (1 << b)) {
+				reversed |= 1 << (log2_length - 1 - b);
+			}
+		}
+		bit_rev[i] = reversed;
+	}
+	twiddle_vec.resize(length / 2);
+	for (int k = 0; k < length / 2; k++) {
+		double angle = 2.0*pi*(double)k / (double)length;
+		twiddle_vec[k] = complex<double>(cos(angle), -sin(angle));
+	}
+}
+
+void FFT_1D::transform(complex<double>* data, const bool inverse) const {
+	if (N <= 1) {
+		return;
+	}
+	if (isPowerOfTwo) {
+		transformRadix2(data, N, bit_reversal, twiddles, inverse);
+	}
+	else {
+		// The inverse transform is obtained by conjugating the input and output of the forward transform
+		for (int n = 0; n < N; n++) {
+			work[n] = (inverse ? conj(data[n]) : data[n])*chirp[n];
+		}
+		fill(work.begin() + N, work.end(), complex<double>(0.0, 0.0));
+		transformRadix2(work.data(), M, bit_reversal_M, twiddles_M, false);
+		for (int m = 0; m < M; m++) {
+			work[m] *= chirp_filter_fft[m];
+		}
+		transformRadix2(work.data(), M, bit_reversal_M, twiddles_M, true);
+		for (int m = 0; m < M; m++) {
+			work[m] /= (double)M;
+		}
+		for (int n = 0; n < N; n++) {
+			data[n] = work[n] * chirp[n];
+			if (inverse) {
+				data[n] = conj(data[n]);
+			}
+		}
+	}
+	if (inverse) {
+		for (int n = 0; n < N; n++) {
+			data[n] /= (double)N;
+		}
+	}
+}
+
+void FFT_1D::transformRadix2(complex<double>* data, const int length, const vector<int>& bit_rev, const vector<complex<double>>& twiddle_vec, const bool inverse) {
+	for (int i = 0; i < length; i++) {
+		if (i < bit_rev[i]) {
+			swap(data[i], data[bit_rev[i]]);
+		}
+	}
+	for (int len = 2; len <= length; len <<= 1) {
+		int half = len / 2;
+		int step = length / len;
+		for (int i = 0; i < length; i += len) {
+			for (int j = 0; j < half; j++) {
+				complex<double> w = inverse ? conj(twiddle_vec[j*step]) : twiddle_vec[j*step];
+				complex<double> u = data[i + j];
+				complex<double> v = data[i + j + half] * w;
+				data[i + j] = u + v;
+				data[i + j + half] = u - v;
+			}
+		}
+	}
+}
+
+namespace FFT {
+
+	void transformLines(vector<complex<double>>& data, const int axis, const int Nx, const int Ny, const int Nz, const bool inverse, const long int line_start, const long int line_end) {
+		// Lines are indexed by the two coordinates perpendicular to the transform axis
+		const int N = (axis == 0) ? Nx : ((axis == 1) ? Ny : Nz);
+		const long int stride = (axis == 0) ? (long int)Ny*Nz : ((axis == 1) ? Nz : 1);
+		const int N_minor = (axis == 2) ? Ny : Nz;
+		FFT_1D fft(N);
+		vector<complex<double>> line(N);
+		for (long int line_index = line_start; line_index < line_end; line_index++) {
+			long int major = line_index / N_minor;
+			long int minor = line_index % N_minor;
+			long int offset;
+			if (axis == 0) {
+				offset = major*Nz + minor;
+			}
+			else if (axis == 1) {
+				offset = major*Ny*Nz + minor;
+			}
+			else {
+				offset = (major*Ny + minor)*Nz;
+			}
+			// z-direction lines are contiguous in memory and are transformed in place
+			if (stride == 1) {
+				fft.transform(&data[offset], inverse);
+				continue;
+			}
+			for (int n = 0; n < N; n++) {
+				line[n] = data[offset + n*stride];
+			}
+			fft.transform(line.data(), inverse);
+			for (int n = 0; n < N; n++) {
+				data[offset + n*stride] = line[n];
+			}
+		}
+	}
+
+	void transform3D(vector<complex<double>>& data, const int Nx, const int Ny, const int Nz, const bool inverse, const int N_threads) {
+		const int dims[3] = { Nx, Ny, Nz };
+		for (int axis = 2; axis >= 0; axis--) {
+			if (dims[axis] <= 1) {
+				continue;
+			}
+			long int N_lines = ((long int)Nx*Ny*Nz) / dims[axis];
+			// Each line is transformed independently, so the result does not depend on the number of threads
+			int N_workers = (int)min((long int)max(N_threads, 1), N_lines);
+			vector<thread> workers;
+			for (int t = 1; t < N_workers; t++) {
+				workers.push_back(thread(transformLines, ref(data), axis, Nx, Ny, Nz, inverse, (t*N_lines) / N_workers, ((t + 1)*N_lines) / N_workers));
+			}
+			transformLines(data, axis, Nx, Ny, Nz, inverse, 0, N_lines / N_workers);
+			for (auto& worker : workers) {
+				worker.join();
+			}
+		}
+	}
+
+	int nextPowerOfTwo(const int value) {
+		int result = 1;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+}
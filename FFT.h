@@ -0,0 +1,70 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+//! \brief This class performs one-dimensional discrete Fourier transforms of a fixed length.
+//! \details Power-of-two lengths use an iterative radix-2 algorithm and all other lengths are handled with Bluestein's algorithm,
+//! so that periodic lattice dimensions of any size can be transformed without padding.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class FFT_1D {
+	public:
+		//! \brief Constructs a transform object and precalculates the twiddle factors for the given length.
+		//! \param length is the number of points in each transformed data set.
+		explicit FFT_1D(const int length);
+
+		//! \brief Gets the transform length.
+		int getLength() const { return N; }
+
+		//! \brief Performs an in-place transform of the data.
+		//! \warning An internal work buffer is used for non-power-of-two lengths, so a single FFT_1D object must not be shared between threads.
+		//! \param data is a pointer to the first of N contiguous complex values.
+		//! \param inverse indicates whether to perform the inverse transform, which includes the 1/N normalization.
+		void transform(std::complex<double>* data, const bool inverse) const;
+
+	private:
+		int N;
+		bool isPowerOfTwo;
+		// Radix-2 data
+		std::vector<int> bit_reversal;
+		std::vector<std::complex<double>> twiddles;
+		// Bluestein data
+		int M = 0;
+		std::vector<std::complex<double>> chirp;
+		std::vector<std::complex<double>> chirp_filter_fft;
+		std::vector<std::complex<double>> twiddles_M;
+		std::vector<int> bit_reversal_M;
+		mutable std::vector<std::complex<double>> work;
+
+		static void calculateRadix2Data(const int length, std::vector<int>& bit_rev, std::vector<std::complex<double>>& twiddle_vec);
+
+		static void transformRadix2(std::complex<double>* data, const int length, const std::vector<int>& bit_rev, const std::vector<std::complex<double>>& twiddle_vec, const bool inverse);
+};
+
+namespace FFT {
+
+	//! \brief Performs an in-place three-dimensional transform of data stored with index (x*Ny + y)*Nz + z.
+	//! \param data is the data vector, which must contain Nx*Ny*Nz values.
+	//! \param Nx is the size of the x-dimension.
+	//! \param Ny is the size of the y-dimension.
+	//! \param Nz is the size of the z-dimension.
+	//! \param inverse indicates whether to perform the normalized inverse transform.
+	//! \param N_threads is the number of threads used to transform independent lines in parallel.
+	void transform3D(std::vector<std::complex<double>>& data, const int Nx, const int Ny, const int Nz, const bool inverse, const int N_threads = 1);
+
+	//! \brief Transforms a range of the one-dimensional lines of a three-dimensional data set along the specified axis (0 = x, 1 = y, 2 = z).
+	void transformLines(std::vector<std::complex<double>>& data, const int axis, const int Nx, const int Ny, const int Nz, const bool inverse, const long int line_start, const long int line_end);
+
+	//! \brief Gets the smallest power of two that is greater than or equal to the input value.
+	int nextPowerOfTwo(const int value);
+}
+
+#endif // FFT_H
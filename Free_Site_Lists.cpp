@@ -0,0 +1,52 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Free_Site_Lists.h"
+#include <algorithm>
+
+using namespace std;
+
+void Free_Site_Lists::init(const int N_types, const int N_indices) {
+	site_lists.assign(N_types, vector<int>());
+	positions.assign(N_indices, -1);
+}
+
+void Free_Site_Lists::addSite(const int type, const int index) {
+	if (positions[index] >= 0) {
+		return;
+	}
+	positions[index] = (int)site_lists[type].size();
+	site_lists[type].push_back(index);
+}
+
+int Free_Site_Lists::chooseRandomSite(const int type, mt19937& gen) const {
+	uniform_int_distribution<int> dist(0, (int)site_lists[type].size() - 1);
+	return site_lists[type][dist(gen)];
+}
+
+vector<int> Free_Site_Lists::chooseRandomSites(const int type, const int N_sites, mt19937& gen) {
+	vector<int>& site_list = site_lists[type];
+	for (int i = 0; i < N_sites; i++) {
+		uniform_int_distribution<int> dist(i, (int)site_list.size() - 1);
+		int j = dist(gen);
+		swap(site_list[i], site_list[j]);
+		positions[site_list[i]] = i;
+		positions[site_list[j]] = j;
+	}
+	return vector<int>(site_list.begin(), site_list.begin() + N_sites);
+}
+
+void Free_Site_Lists::removeSite(const int type, const int index) {
+	int position = positions[index];
+	if (position < 0) {
+		return;
+	}
+	// The last entry is moved into the position of the removed entry
+	int index_last = site_lists[type].back();
+	site_lists[type][position] = index_last;
+	positions[index_last] = position;
+	site_lists[type].pop_back();
+	positions[index] = -1;
+}
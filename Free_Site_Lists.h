@@ -0,0 +1,51 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef FREE_SITE_LISTS_H
+#define FREE_SITE_LISTS_H
+
+#include <random>
+#include <vector>
+
+//! \brief This class keeps lists of the indices of the unoccupied sites of each site type, so that a random unoccupied site of a given type can be chosen in constant time.
+//! \details Each site index can be in at most one list.  The position of every index within its list is stored, so sites are added and removed in constant time by
+//! swapping the removed entry with the last entry of the list.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Free_Site_Lists {
+	public:
+		//! \brief Initializes empty lists.
+		//! \param N_types is the number of lists, which are indexed by site type from 0 to N_types-1.
+		//! \param N_indices is the number of possible site indices, which range from 0 to N_indices-1.
+		void init(const int N_types, const int N_indices);
+
+		//! \brief Adds the site index to the list for the specified type, unless the site is already in a list.
+		void addSite(const int type, const int index);
+
+		//! \brief Chooses a site index from the list for the specified type with uniform probability.
+		//! \warning The list must not be empty.
+		int chooseRandomSite(const int type, std::mt19937& gen) const;
+
+		//! \brief Chooses the specified number of distinct site indices from the list for the specified type with uniform probability.
+		//! \details A partial Fisher-Yates shuffle moves the sample to the front of the list, so the cost is proportional to the sample size.
+		//! \warning The list must contain at least N_sites site indices.
+		std::vector<int> chooseRandomSites(const int type, const int N_sites, std::mt19937& gen);
+
+		//! \brief Checks whether the site index is in any of the lists.
+		bool containsSite(const int index) const { return positions[index] >= 0; }
+
+		//! \brief Gets the number of site indices in the list for the specified type.
+		int getNumSites(const int type) const { return (int)site_lists[type].size(); }
+
+		//! \brief Removes the site index from the list for the specified type, if it is present.
+		void removeSite(const int type, const int index);
+
+	private:
+		std::vector<std::vector<int>> site_lists;
+		std::vector<int> positions;
+};
+
+#endif // FREE_SITE_LISTS_H
@@ -0,0 +1,105 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Log_Bins.h"
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Previous transit time binning of the removed OSC_Sim::calculateTransitTimeDist function, which returns -1 when the value is not inside any bin
+int getBinIndexPrevious(const vector<double>& transient_times, const int pnts_per_decade, const double value) {
+	double step_size = 1.0 / (double)pnts_per_decade;
+	for (int j = 0; j < (int)transient_times.size(); j++) {
+		if (value > pow(10, log10(transient_times[j]) - 0.5*step_size) && value < pow(10, log10(transient_times[j]) + 0.5*step_size)) {
+			return j;
+		}
+	}
+	return -1;
+}
+
+int main() {
+	int N_failures = 0;
+	const double start = 1e-13;
+	const int pnts_per_decade = 20;
+	const int N_bins = 141;
+	Log_Bins bins(start, pnts_per_decade, N_bins);
+	vector<double> transient_times = bins.getBinCenters();
+	// Random values inside the bin range must be assigned to the same bin as before, except for values within rounding error of a bin edge
+	mt19937 generator(12345);
+	uniform_real_distribution<double> dist(log10(bins.getEdge(0)), log10(bins.getEdge(N_bins)));
+	int N_near_edge = 0;
+	for (int n = 0; n < 1000000; n++) {
+		double value = pow(10, dist(generator));
+		int index = bins.getBinIndex(value);
+		int index_previous = getBinIndexPrevious(transient_times, pnts_per_decade, value);
+		if (index == index_previous) {
+			continue;
+		}
+		bool isNearEdge = false;
+		for (int i = 0; i <= N_bins; i++) {
+			if (fabs(value - bins.getEdge(i)) <= 1e-12*value) {
+				isNearEdge = true;
+			}
+		}
+		if (isNearEdge) {
+			N_near_edge++;
+		}
+		else {
+			cout << "Error! Value " << value << " is assigned to bin " << index << " instead of bin " << index_previous << "." << endl;
+			N_failures++;
+		}
+	}
+	cout << N_near_edge << " random values within rounding error of a bin edge were assigned differently." << endl;
+	// Values exactly on an inner edge are assigned to the upper bin, whereas the previous strict comparisons could leave them out of all bins
+	int N_edges_uncounted = 0;
+	for (int i = 0; i < N_bins; i++) {
+		double value = bins.getEdge(i);
+		int index = bins.getBinIndex(value);
+		int index_previous = getBinIndexPrevious(transient_times, pnts_per_decade, value);
+		if (index != i) {
+			cout << "Error! Edge value " << value << " is assigned to bin " << index << " instead of the upper bin " << i << "." << endl;
+			N_failures++;
+		}
+		if (index_previous == -1) {
+			N_edges_uncounted++;
+		}
+		else if (index_previous != i - 1 && index_previous != i) {
+			cout << "Error! Edge value " << value << " was previously assigned to bin " << index_previous << "." << endl;
+			N_failures++;
+		}
+	}
+	cout << N_edges_uncounted << " of " << N_bins << " edge values were not counted in any bin by the previous implementation." << endl;
+	// Values below the first bin, including zero and negative values, are reported with index -1, as before
+	vector<double> values_below = { 0.0, -1.0, 0.5*bins.getEdge(0), nextafter(bins.getEdge(0), 0.0), numeric_limits<double>::quiet_NaN() };
+	for (auto value : values_below) {
+		if (bins.getBinIndex(value) != -1 || getBinIndexPrevious(transient_times, pnts_per_decade, value) != -1) {
+			cout << "Error! Value " << value << " below the first bin is not reported with index -1." << endl;
+			N_failures++;
+		}
+	}
+	// Values at or above the upper edge of the last bin are reported with index N_bins, where the previous implementation did not count them
+	vector<double> values_above = { bins.getEdge(N_bins), 2.0*bins.getEdge(N_bins), numeric_limits<double>::infinity() };
+	for (auto value : values_above) {
+		if (bins.getBinIndex(value) != N_bins || getBinIndexPrevious(transient_times, pnts_per_decade, value) != -1) {
+			cout << "Error! Value " << value << " above the last bin is not reported with index " << N_bins << "." << endl;
+			N_failures++;
+		}
+	}
+	// Values just inside the first and last bins
+	if (bins.getBinIndex(nextafter(bins.getEdge(0), 1.0)) != 0 || bins.getBinIndex(nextafter(bins.getEdge(N_bins), 0.0)) != N_bins - 1) {
+		cout << "Error! Values just inside the first or last bin are not assigned to that bin." << endl;
+		N_failures++;
+	}
+	if (N_failures > 0) {
+		cout << N_failures << " Log_Bins tests failed." << endl;
+		return 1;
+	}
+	cout << "All Log_Bins tests passed." << endl;
+	return 0;
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Log_Bins.h"
+#include <cmath>
+
+using namespace std;
+
+Log_Bins::Log_Bins(const double start, const int pnts_per_decade, const int N_bins) {
+	log_start = log10(start);
+	Pnts_per_decade = pnts_per_decade;
+	const double step_size = 1.0 / (double)Pnts_per_decade;
+	edges.assign(N_bins + 1, 0.0);
+	for (int i = 0; i <= N_bins; i++) {
+		edges[i] = pow(10, log_start + (i - 0.5)*step_size);
+	}
+}
+
+int Log_Bins::getBinIndex(const double value) const {
+	const int N_bins = getN_bins();
+	if (!(value >= edges[0])) {
+		return -1;
+	}
+	if (value >= edges[N_bins]) {
+		return N_bins;
+	}
+	int index = (int)floor((log10(value) - log_start)*Pnts_per_decade + 0.5);
+	// Correct for rounding of the logarithm near the bin edges
+	if (index > N_bins - 1 || (index > 0 && value < edges[index])) {
+		index--;
+	}
+	else if (index < 0 || value >= edges[index + 1]) {
+		index++;
+	}
+	return index;
+}
+
+vector<double> Log_Bins::getBinCenters() const {
+	const double step_size = 1.0 / (double)Pnts_per_decade;
+	vector<double> centers(getN_bins());
+	for (int i = 0; i < (int)centers.size(); i++) {
+		centers[i] = pow(10, log_start + i*step_size);
+	}
+	return centers;
+}
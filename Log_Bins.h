@@ -0,0 +1,49 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef LOG_BINS_H
+#define LOG_BINS_H
+
+#include <vector>
+
+//! \brief This class defines a set of log-spaced bins and finds the bin that contains a value in constant time.
+//! \details Bin i is centered on start*10^(i/pnts_per_decade) and extends half a bin width on either side of its center on the log scale.
+//! The bin index is calculated directly from the logarithm of the value and then checked against the precalculated bin edges, so that values
+//! on a bin edge are always assigned consistently to the upper bin.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Log_Bins {
+	public:
+		//! \brief Constructs an empty set of bins.
+		Log_Bins() {}
+
+		//! \brief Constructs and initializes the bins.
+		//! \param start is the center of the first bin.
+		//! \param pnts_per_decade is the number of bins per decade.
+		//! \param N_bins is the number of bins.
+		Log_Bins(const double start, const int pnts_per_decade, const int N_bins);
+
+		//! \brief Gets the index of the bin that contains the value.
+		//! \returns -1 if the value is below the first bin or is not positive.
+		//! \returns the number of bins if the value is at or above the upper edge of the last bin.
+		int getBinIndex(const double value) const;
+
+		//! \brief Gets the centers of all of the bins.
+		std::vector<double> getBinCenters() const;
+
+		//! \brief Gets the edge between bin index-1 and bin index, where index ranges from 0 to the number of bins.
+		double getEdge(const int index) const { return edges[index]; }
+
+		//! \brief Gets the number of bins.
+		int getN_bins() const { return (int)edges.size() - 1; }
+
+	private:
+		double log_start = 0;
+		int Pnts_per_decade = 1;
+		std::vector<double> edges = std::vector<double>(1, 0.0);
+};
+
+#endif // LOG_BINS_H
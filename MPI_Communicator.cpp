@@ -0,0 +1,202 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "MPI_Communicator.h"
+#include <algorithm>
+
+using namespace std;
+
+MPI_Communicator::MPI_Communicator(MPI_Comm comm_in, const bool isOwner_in) : comm(comm_in), isOwner(isOwner_in) {
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+}
+
+MPI_Communicator::~MPI_Communicator() {
+	if (isOwner) {
+		MPI_Comm_free(&comm);
+	}
+}
+
+void MPI_Communicator::abort() {
+	MPI_Abort(comm, 1);
+}
+
+void MPI_Communicator::barrier() {
+	MPI_Barrier(comm);
+}
+
+void MPI_Communicator::broadcast(void* data, const size_t size_bytes, const int root) {
+	// Large buffers are broadcast in chunks to stay within the int count limit of MPI
+	const size_t chunk_size = (size_t)1 << 30;
+	for (size_t offset = 0; offset < size_bytes; offset += chunk_size) {
+		int count = (int)min(chunk_size, size_bytes - offset);
+		MPI_Bcast(static_cast<char*>(data) + offset, count, MPI_BYTE, root, comm);
+	}
+}
+
+vector<int> MPI_Communicator::gather(const int value, const int root) {
+	vector<int> values((rank == root) ? size : 0);
+	MPI_Gather(&value, 1, MPI_INT, values.data(), 1, MPI_INT, root, comm);
+	return values;
+}
+
+vector<string> MPI_Communicator::gather(const string& value, const int root) {
+	vector<int> lengths = gather((int)value.size(), root);
+	vector<int> offsets(lengths.size(), 0);
+	vector<char> data;
+	if (rank == root) {
+		for (int i = 1; i < size; i++) {
+			offsets[i] = offsets[i - 1] + lengths[i - 1];
+		}
+		data.resize(offsets[size - 1] + lengths[size - 1] + 1);
+	}
+	MPI_Gatherv(value.c_str(), (int)value.size(), MPI_CHAR, data.data(), lengths.data(), offsets.data(), MPI_CHAR, root, comm);
+	vector<string> values;
+	for (int i = 0; i < (int)lengths.size(); i++) {
+		values.push_back(string(data.data() + offsets[i], lengths[i]));
+	}
+	return values;
+}
+
+vector<unsigned char> MPI_Communicator::sendReceive(const vector<unsigned char>& data, const int dest, const int source) {
+	// The size is exchanged first, so that the receiving processor can allocate the buffer
+	const int dest_mpi = (dest < 0) ? MPI_PROC_NULL : dest;
+	const int source_mpi = (source < 0) ? MPI_PROC_NULL : source;
+	long int size_send = (long int)data.size();
+	long int size_receive = 0;
+	MPI_Sendrecv(&size_send, 1, MPI_LONG, dest_mpi, 0, &size_receive, 1, MPI_LONG, source_mpi, 0, comm, MPI_STATUS_IGNORE);
+	vector<unsigned char> data_receive(size_receive);
+	MPI_Sendrecv(data.data(), (int)size_send, MPI_UNSIGNED_CHAR, dest_mpi, 1, data_receive.data(), (int)size_receive, MPI_UNSIGNED_CHAR, source_mpi, 1, comm, MPI_STATUS_IGNORE);
+	return data_receive;
+}
+
+vector<vector<unsigned char>> MPI_Communicator::exchangeAll(const vector<vector<unsigned char>>& data) {
+	// The sizes are exchanged first, so that each processor can allocate the buffer for the data it receives
+	vector<int> sizes_send(size, 0);
+	vector<int> offsets_send(size, 0);
+	vector<unsigned char> data_send;
+	for (int i = 0; i < size; i++) {
+		sizes_send[i] = (int)data[i].size();
+		offsets_send[i] = (int)data_send.size();
+		data_send.insert(data_send.end(), data[i].begin(), data[i].end());
+	}
+	vector<int> sizes_receive(size, 0);
+	MPI_Alltoall(sizes_send.data(), 1, MPI_INT, sizes_receive.data(), 1, MPI_INT, comm);
+	vector<int> offsets_receive(size, 0);
+	for (int i = 1; i < size; i++) {
+		offsets_receive[i] = offsets_receive[i - 1] + sizes_receive[i - 1];
+	}
+	vector<unsigned char> data_receive(offsets_receive[size - 1] + sizes_receive[size - 1]);
+	MPI_Alltoallv(data_send.data(), sizes_send.data(), offsets_send.data(), MPI_UNSIGNED_CHAR, data_receive.data(), sizes_receive.data(), offsets_receive.data(), MPI_UNSIGNED_CHAR, comm);
+	vector<vector<unsigned char>> data_all;
+	for (int i = 0; i < size; i++) {
+		data_all.push_back(vector<unsigned char>(data_receive.begin() + offsets_receive[i], data_receive.begin() + offsets_receive[i] + sizes_receive[i]));
+	}
+	return data_all;
+}
+
+void MPI_Communicator::reduce(vector<double>& data, Reduce_Function function, const int root) {
+	// The data of all processors is gathered and combined on the root processor in rank order, because the evaluation order of an MPI_Reduce call
+	// with a user-defined operation depends on the MPI implementation
+	const int N_values = (int)data.size();
+	vector<double> data_all((rank == root) ? (size_t)N_values*size : 0);
+	MPI_Gather(data.data(), N_values, MPI_DOUBLE, data_all.data(), N_values, MPI_DOUBLE, root, comm);
+	if (rank == root) {
+		copy(data_all.end() - N_values, data_all.end(), data.begin());
+		for (int i = size - 2; i >= 0; i--) {
+			function(data_all.data() + (size_t)i*N_values, data.data(), N_values);
+		}
+	}
+}
+
+void MPI_Communicator::startSum(const int* input, int* output, const int count) {
+	MPI_Iallreduce(input, output, count, MPI_INT, MPI_SUM, comm, &sum_request);
+}
+
+bool MPI_Communicator::testSum() {
+	int isComplete = 0;
+	MPI_Test(&sum_request, &isComplete, MPI_STATUS_IGNORE);
+	return isComplete != 0;
+}
+
+void MPI_Communicator::waitSum() {
+	MPI_Wait(&sum_request, MPI_STATUS_IGNORE);
+}
+
+void MPI_Communicator::createCounter() {
+	// The counter is stored in a window on processor 0 and is updated with passive target atomic operations
+	long int* counter;
+	MPI_Win_allocate((rank == 0) ? (MPI_Aint)sizeof(long int) : 0, (int)sizeof(long int), MPI_INFO_NULL, comm, &counter, &counter_window);
+	if (rank == 0) {
+		*counter = 0;
+	}
+	MPI_Barrier(comm);
+	MPI_Win_lock_all(0, counter_window);
+}
+
+long int MPI_Communicator::fetchAndAddCounter(const long int increment) {
+	long int value_prev;
+	MPI_Fetch_and_op(&increment, &value_prev, MPI_LONG, 0, 0, MPI_SUM, counter_window);
+	MPI_Win_flush(0, counter_window);
+	return value_prev;
+}
+
+void MPI_Communicator::resetCounter() {
+	MPI_Barrier(comm);
+	if (rank == 0) {
+		long int value_new = 0;
+		long int value_prev;
+		MPI_Fetch_and_op(&value_new, &value_prev, MPI_LONG, 0, 0, MPI_REPLACE, counter_window);
+		MPI_Win_flush(0, counter_window);
+	}
+	MPI_Barrier(comm);
+}
+
+void MPI_Communicator::freeCounter() {
+	if (counter_window != MPI_WIN_NULL) {
+		MPI_Win_unlock_all(counter_window);
+		MPI_Win_free(&counter_window);
+	}
+}
+
+void MPI_Communicator::freeSharedArrays() {
+	for (auto& window : shared_windows) {
+		MPI_Win_free(&window);
+	}
+	shared_windows.clear();
+}
+
+unique_ptr<Communicator> MPI_Communicator::split(const int color) {
+	MPI_Comm comm_new;
+	MPI_Comm_split(comm, color, rank, &comm_new);
+	return unique_ptr<Communicator>(new MPI_Communicator(comm_new, true));
+}
+
+unique_ptr<Communicator> MPI_Communicator::splitShared(const int color) {
+	MPI_Comm node_comm;
+	MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+	MPI_Comm comm_new;
+	MPI_Comm_split(node_comm, color, rank, &comm_new);
+	MPI_Comm_free(&node_comm);
+	return unique_ptr<Communicator>(new MPI_Communicator(comm_new, true));
+}
+
+const unsigned char* MPI_Communicator::createSharedArray(const size_t size_bytes, const function<void(unsigned char*)>& fill) {
+	unsigned char* data;
+	MPI_Win window;
+	MPI_Win_allocate_shared((rank == 0) ? (MPI_Aint)size_bytes : 0, 1, MPI_INFO_NULL, comm, &data, &window);
+	if (rank == 0) {
+		fill(data);
+	}
+	else {
+		MPI_Aint window_size;
+		int disp_unit;
+		MPI_Win_shared_query(window, 0, &window_size, &disp_unit, &data);
+	}
+	// The fence makes the data written by processor 0 visible to the other processors
+	MPI_Win_fence(0, window);
+	shared_windows.push_back(window);
+	return data;
+}
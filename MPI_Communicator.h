@@ -0,0 +1,63 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef MPI_COMMUNICATOR_H
+#define MPI_COMMUNICATOR_H
+
+#include "Communicator.h"
+#include <mpi.h>
+
+//! \brief This class implements the Communicator interface with MPI, with each processor being an MPI process.
+//! \details The communicator wraps an existing MPI communicator, and the MPI communicators created by split and splitShared are freed when the
+//! new communicators are destroyed.  The shared counter and shared arrays must be freed explicitly, because freeing an MPI window waits for all
+//! processors, which would block a processor that ends early after an error.  MPI must be initialized before the first communicator is created
+//! and finalized after the last one is destroyed.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class MPI_Communicator : public Communicator {
+	public:
+		//! \brief Constructs a communicator that uses the MPI communicator.
+		//! \param comm is the MPI communicator to use.
+		//! \param isOwner determines whether the MPI communicator is freed when this communicator is destroyed.
+		explicit MPI_Communicator(MPI_Comm comm, const bool isOwner = false);
+		~MPI_Communicator();
+		MPI_Communicator(const MPI_Communicator&) = delete;
+		MPI_Communicator& operator=(const MPI_Communicator&) = delete;
+		int getRank() const { return rank; }
+		int getSize() const { return size; }
+		double getWallTime() const { return MPI_Wtime(); }
+		void abort();
+		void barrier();
+		void broadcast(void* data, const size_t size, const int root);
+		std::vector<int> gather(const int value, const int root);
+		std::vector<std::string> gather(const std::string& value, const int root);
+		std::vector<unsigned char> sendReceive(const std::vector<unsigned char>& data, const int dest, const int source);
+		std::vector<std::vector<unsigned char>> exchangeAll(const std::vector<std::vector<unsigned char>>& data);
+		void reduce(std::vector<double>& data, Reduce_Function function, const int root);
+		void startSum(const int* input, int* output, const int count);
+		bool isSumPending() const { return sum_request != MPI_REQUEST_NULL; }
+		bool testSum();
+		void waitSum();
+		void createCounter();
+		long int fetchAndAddCounter(const long int increment);
+		void resetCounter();
+		void freeCounter();
+		void freeSharedArrays();
+		std::unique_ptr<Communicator> split(const int color);
+		std::unique_ptr<Communicator> splitShared(const int color);
+		const unsigned char* createSharedArray(const size_t size, const std::function<void(unsigned char*)>& fill);
+
+	private:
+		MPI_Comm comm;
+		bool isOwner;
+		int rank = 0;
+		int size = 1;
+		MPI_Request sum_request = MPI_REQUEST_NULL;
+		MPI_Win counter_window = MPI_WIN_NULL;
+		std::vector<MPI_Win> shared_windows;
+};
+
+#endif // MPI_COMMUNICATOR_H
@@ -0,0 +1,248 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Morphology.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+Morphology_File_Map::~Morphology_File_Map() {
+	close();
+}
+
+void Morphology_File_Map::close() {
+#ifndef _WIN32
+	if (isMapped) {
+		munmap(const_cast<unsigned char*>(data), data_size);
+	}
+#endif
+	buffer.clear();
+	data = nullptr;
+	data_size = 0;
+	isMapped = false;
+}
+
+bool Morphology_File_Map::open(const string& filename, string& error_message) {
+	close();
+#ifndef _WIN32
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		error_message = "Binary morphology file could not be opened.";
+		return false;
+	}
+	struct stat file_stats;
+	if (fstat(fd, &file_stats) != 0 || (size_t)file_stats.st_size < sizeof(Morphology_Header)) {
+		::close(fd);
+		error_message = "Binary morphology file is too small to contain a valid header.";
+		return false;
+	}
+	data_size = (size_t)file_stats.st_size;
+	void* address = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (address == MAP_FAILED) {
+		data_size = 0;
+		error_message = "Binary morphology file could not be mapped into memory.";
+		return false;
+	}
+	data = static_cast<const unsigned char*>(address);
+	isMapped = true;
+#else
+	ifstream file(filename.c_str(), ifstream::in | ifstream::binary);
+	if (!file.good()) {
+		error_message = "Binary morphology file could not be opened.";
+		return false;
+	}
+	buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	if (buffer.size() < sizeof(Morphology_Header)) {
+		buffer.clear();
+		error_message = "Binary morphology file is too small to contain a valid header.";
+		return false;
+	}
+	data = buffer.data();
+	data_size = buffer.size();
+#endif
+	const Morphology_Header& header = getHeader();
+	if (memcmp(header.format_id, Morphology::Format_id, sizeof(Morphology::Format_id)) != 0) {
+		close();
+		error_message = "Binary morphology file format not recognized.";
+		return false;
+	}
+	if (header.version != Morphology::Format_version) {
+		close();
+		error_message = "Binary morphology file version is not supported.";
+		return false;
+	}
+	if (!(header.bits_per_site == 1 || header.bits_per_site == 2 || header.bits_per_site == 4 || header.bits_per_site == 8)) {
+		close();
+		error_message = "Binary morphology file has an invalid number of bits per site.";
+		return false;
+	}
+	if (data_size < sizeof(Morphology_Header) + Morphology::calculatePackedSize(header)) {
+		close();
+		error_message = "Binary morphology file is truncated.";
+		return false;
+	}
+	return true;
+}
+
+namespace Morphology {
+
+	size_t calculatePackedSize(const Morphology_Header& header) {
+		size_t N_sites = (size_t)header.length*(size_t)header.width*(size_t)header.height;
+		return (N_sites*header.bits_per_site + 7) / 8;
+	}
+
+	Morphology_Header createHeader(const int length, const int width, const int height, const int max_type) {
+		Morphology_Header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.format_id, Format_id, sizeof(Format_id));
+		header.version = Format_version;
+		header.length = length;
+		header.width = width;
+		header.height = height;
+		header.boundary_x = -1;
+		header.boundary_y = -1;
+		header.boundary_z = -1;
+		header.N_types = (uint8_t)max_type;
+		header.bits_per_site = 8;
+		if (max_type < 2) {
+			header.bits_per_site = 1;
+		}
+		else if (max_type < 4) {
+			header.bits_per_site = 2;
+		}
+		else if (max_type < 16) {
+			header.bits_per_site = 4;
+		}
+		return header;
+	}
+
+	bool isBinaryMorphologyFile(const string& filename) {
+		ifstream file(filename.c_str(), ifstream::in | ifstream::binary);
+		char id[sizeof(Format_id)];
+		if (!file.read(id, sizeof(id))) {
+			return false;
+		}
+		return memcmp(id, Format_id, sizeof(Format_id)) == 0;
+	}
+
+	bool importCompressedTextMorphology(istream& input, Morphology_Header& header, vector<unsigned char>& packed_types, string& error_message) {
+		string line;
+		bool isV3 = false;
+		bool isV4 = false;
+		// Get input morphology file information
+		getline(input, line);
+		if (line.find("Ising_OPV v3.2 - compressed format") != string::npos) {
+			isV3 = true;
+		}
+		else if (line.find("Ising_OPV v4.0") != string::npos && line.find("compressed") != string::npos && line.find("uncompressed") == string::npos) {
+			isV4 = true;
+		}
+		else {
+			error_message = "Morphology file format not recognized. Only compressed morphologies created using Ising_OPV v3.2 and v4.0 are currently supported.";
+			return false;
+		}
+		getline(input, line);
+		int length = atoi(line.c_str());
+		getline(input, line);
+		int width = atoi(line.c_str());
+		getline(input, line);
+		int height = atoi(line.c_str());
+		if (!(length > 0) || !(width > 0) || !(height > 0)) {
+			error_message = "Morphology file lattice dimensions are not valid.";
+			return false;
+		}
+		int boundary[3] = { -1, -1, -1 };
+		if (isV3) {
+			// Skip 3 lines (domain size1, domain size2, blend ratio)
+			getline(input, line);
+			getline(input, line);
+			getline(input, line);
+		}
+		else if (isV4) {
+			// boundary conditions
+			for (int i = 0; i < 3; i++) {
+				getline(input, line);
+				boundary[i] = (atoi(line.c_str()) != 0 || line.find("true") != string::npos) ? 1 : 0;
+			}
+			// number of site types
+			getline(input, line);
+			int N_types = atoi(line.c_str());
+			// skip domain size and mix fraction lines
+			for (int i = 0; i < 2 * N_types; i++) {
+				getline(input, line);
+			}
+		}
+		// Parse the run-length encoded site data in site index order
+		long int N_sites = (long int)length*width*height;
+		vector<unsigned char> types(N_sites, 0);
+		long int site_index = 0;
+		while (site_index < N_sites) {
+			if (!input.good()) {
+				error_message = "Error parsing imported morphology file.  End of file reached before expected.";
+				return false;
+			}
+			getline(input, line);
+			int type = atoi(line.substr(0, 1).c_str());
+			long int site_count = (line.size() > 1) ? atol(line.substr(1).c_str()) : 0;
+			// Malformed lines must not produce an inverted fill range
+			if (type < 1 || type > 2 || site_count <= 0) {
+				error_message = "Error parsing imported morphology file.  Each site data line must contain a site type of 1 or 2 followed by a positive number of sites.";
+				return false;
+			}
+			long int count = min(site_count, N_sites - site_index);
+			fill(types.begin() + site_index, types.begin() + site_index + count, (unsigned char)type);
+			site_index += count;
+		}
+		header = createHeader(length, width, height, *max_element(types.begin(), types.end()));
+		header.boundary_x = (int8_t)boundary[0];
+		header.boundary_y = (int8_t)boundary[1];
+		header.boundary_z = (int8_t)boundary[2];
+		// Pack the site types
+		packed_types.assign(calculatePackedSize(header), 0);
+		for (long int n = 0; n < N_sites; n++) {
+			long int bit_index = n*header.bits_per_site;
+			packed_types[bit_index / 8] |= (unsigned char)(types[n] << (bit_index % 8));
+		}
+		return true;
+	}
+
+	bool loadMorphology(const string& filename, Morphology_Header& header, vector<unsigned char>& packed_types, string& error_message) {
+		if (isBinaryMorphologyFile(filename)) {
+			Morphology_File_Map morphology_map;
+			if (!morphology_map.open(filename, error_message)) {
+				return false;
+			}
+			header = morphology_map.getHeader();
+			packed_types.assign(morphology_map.getPackedTypes(), morphology_map.getPackedTypes() + calculatePackedSize(header));
+			return true;
+		}
+		ifstream input(filename.c_str(), ifstream::in);
+		if (!input.good()) {
+			error_message = "Morphology file could not be opened.";
+			return false;
+		}
+		return importCompressedTextMorphology(input, header, packed_types, error_message);
+	}
+
+	bool writeBinaryMorphology(const string& filename, const Morphology_Header& header, const vector<unsigned char>& packed_types) {
+		ofstream file(filename.c_str(), ofstream::out | ofstream::binary | ofstream::trunc);
+		if (!file.good()) {
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(packed_types.data()), packed_types.size());
+		return file.good();
+	}
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef MORPHOLOGY_H
+#define MORPHOLOGY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+//! \brief This struct is the fixed size header at the start of a binary morphology file.
+//! \details The header is followed by the bit-packed site types in site index order (x, then y, then z), with bits_per_site bits per site
+//! and the lowest bits of each byte holding the first site.  Boundary condition values are 1 for periodic, 0 for non-periodic, and -1 when
+//! the source file did not specify the boundary conditions.
+struct Morphology_Header {
+	char format_id[8];
+	int32_t version;
+	int32_t length;
+	int32_t width;
+	int32_t height;
+	int8_t boundary_x;
+	int8_t boundary_y;
+	int8_t boundary_z;
+	uint8_t N_types;
+	uint8_t bits_per_site;
+	uint8_t reserved[3];
+};
+
+//! \brief This class provides read-only access to a binary morphology file by mapping the file into memory.
+//! \details The site type data is used directly from the mapped file without any parsing.  On systems without mmap, the file is read into memory instead.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Morphology_File_Map {
+	public:
+		Morphology_File_Map() {}
+		~Morphology_File_Map();
+		// The mapped memory or buffer is owned by the object, so copying would unmap it twice or point into the buffer of the other object
+		Morphology_File_Map(const Morphology_File_Map&) = delete;
+		Morphology_File_Map& operator=(const Morphology_File_Map&) = delete;
+
+		//! \brief Maps the binary morphology file and validates the header.
+		//! \param filename is the name of the binary morphology file.
+		//! \param error_message is set to a description of the problem when the file cannot be used.
+		//! \return true if the file was mapped successfully and false otherwise.
+		bool open(const std::string& filename, std::string& error_message);
+
+		//! \brief Unmaps the file.
+		void close();
+
+		//! \brief Gets the header of the mapped file.
+		const Morphology_Header& getHeader() const { return *reinterpret_cast<const Morphology_Header*>(data); }
+
+		//! \brief Gets a pointer to the bit-packed site type data.
+		const unsigned char* getPackedTypes() const { return data + sizeof(Morphology_Header); }
+
+	private:
+		const unsigned char* data = nullptr;
+		size_t data_size = 0;
+		std::vector<unsigned char> buffer;
+		bool isMapped = false;
+};
+
+namespace Morphology {
+
+	//! The identifier string at the start of every binary morphology file.
+	static const char Format_id[8] = { 'E','X','C','M','O','R','P','H' };
+
+	//! The current version of the binary morphology format.
+	static const int32_t Format_version = 1;
+
+	//! \brief Calculates the size in bytes of the bit-packed site type data.
+	size_t calculatePackedSize(const Morphology_Header& header);
+
+	//! \brief Creates a header for a morphology with the given dimensions and maximum site type value.
+	Morphology_Header createHeader(const int length, const int width, const int height, const int max_type);
+
+	//! \brief Determines whether the file starts with the binary morphology format identifier.
+	bool isBinaryMorphologyFile(const std::string& filename);
+
+	//! \brief Gets the type of the site with the specified site index from the bit-packed site type data.
+	inline short getPackedType(const unsigned char* packed_types, const int bits_per_site, const long int site_index) {
+		const long int bit_index = site_index*bits_per_site;
+		return (short)((packed_types[bit_index / 8] >> (bit_index % 8)) & ((1 << bits_per_site) - 1));
+	}
+
+	//! \brief Imports a compressed text morphology file created by Ising_OPV v3.2 or v4.0 and packs the site types.
+	//! \param input is the input stream of the morphology file.
+	//! \param header is the header that is created from the morphology file information.
+	//! \param packed_types is the vector that will hold the bit-packed site types.
+	//! \param error_message is set to a description of the problem when the file cannot be imported.
+	//! \return true if the morphology was imported successfully and false otherwise.
+	bool importCompressedTextMorphology(std::istream& input, Morphology_Header& header, std::vector<unsigned char>& packed_types, std::string& error_message);
+
+	//! \brief Loads a binary or compressed text morphology file into a header and bit-packed site type data.
+	//! \param filename is the name of the morphology file, whose format is detected from the file contents.
+	//! \param header is the header of the loaded morphology.
+	//! \param packed_types is the vector that will hold the bit-packed site types.
+	//! \param error_message is set to a description of the problem when the file cannot be loaded.
+	//! \return true if the morphology was loaded successfully and false otherwise.
+	bool loadMorphology(const std::string& filename, Morphology_Header& header, std::vector<unsigned char>& packed_types, std::string& error_message);
+
+	//! \brief Writes a binary morphology file.
+	//! \return true if the file was written successfully and false otherwise.
+	bool writeBinaryMorphology(const std::string& filename, const Morphology_Header& header, const std::vector<unsigned char>& packed_types);
+}
+
+#endif // MORPHOLOGY_H
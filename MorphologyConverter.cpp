@@ -0,0 +1,50 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Morphology.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Converts compressed text morphology files created by Ising_OPV v3.2 or v4.0 into the binary morphology format.
+// Usage: MorphologyConverter.exe input_file [output_file]
+// When no output filename is given, the extension of the input filename is replaced with .bin.
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		cout << "Usage: MorphologyConverter.exe input_file [output_file]" << endl;
+		return 1;
+	}
+	string input_filename = argv[1];
+	string output_filename;
+	if (argc == 3) {
+		output_filename = argv[2];
+	}
+	else {
+		size_t pos = input_filename.find_last_of('.');
+		output_filename = (pos == string::npos ? input_filename : input_filename.substr(0, pos)) + ".bin";
+	}
+	ifstream input_file(input_filename.c_str(), ifstream::in);
+	if (!input_file.good()) {
+		cout << "Error opening morphology file " << input_filename << " for conversion." << endl;
+		return 1;
+	}
+	Morphology_Header header;
+	vector<unsigned char> packed_types;
+	string error_message;
+	if (!Morphology::importCompressedTextMorphology(input_file, header, packed_types, error_message)) {
+		cout << "Error! " << error_message << endl;
+		return 1;
+	}
+	input_file.close();
+	if (!Morphology::writeBinaryMorphology(output_filename, header, packed_types)) {
+		cout << "Error writing binary morphology file " << output_filename << "." << endl;
+		return 1;
+	}
+	cout << "Converted " << input_filename << " (" << header.length << "x" << header.width << "x" << header.height << ", " << (int)header.bits_per_site << " bits per site) to " << output_filename << "." << endl;
+	return 0;
+}
@@ -29,6 +29,7 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
     Simulation::init(params,id);
     // Set Additional General Parameters
     Internal_potential = params.Internal_potential;
+    N_threads = params.N_threads;
     // Morphology Parameters
     Enable_neat = params.Enable_neat;
     Enable_bilayer = params.Enable_bilayer;
@@ -36,8 +37,18 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
     Thickness_acceptor = params.Thickness_acceptor;
     Enable_random_blend = params.Enable_random_blend;
     Acceptor_conc = params.Acceptor_conc;
+    Enable_ising_blend = params.Enable_ising_blend;
+    Ising_interaction_energy = params.Ising_interaction_energy;
+    Ising_MC_steps = params.Ising_MC_steps;
+    Ising_smoothing_threshold = params.Ising_smoothing_threshold;
     Enable_import_morphology = params.Enable_import_morphology;
     Morphology_file = params.Morphology_file;
+	Morphology_filename = params.Morphology_filename;
+	Morphology_header = params.Morphology_header;
+	Morphology_packed_types = params.Morphology_packed_types;
+	Shared_site_types = params.Shared_site_types;
+	Previous_sim = params.Previous_sim;
+	Enable_site_energy_reuse = params.Enable_site_energy_reuse;
     // Test Parameters
     N_tests = params.N_tests;
     Enable_exciton_diffusion_test = params.Enable_exciton_diffusion_test;
@@ -49,6 +60,12 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
     //ToF_pnts_per_decade = params.ToF_pnts_per_decade;
     Enable_IQE_test = params.Enable_IQE_test;
     IQE_time_cutoff = params.IQE_time_cutoff;
+    Raw_data_sample_size = params.Raw_data_sample_size;
+    Enable_trajectory_recording = params.Enable_trajectory_recording;
+    Trajectory_species_mask = params.Trajectory_species_mask;
+    Trajectory_sampling_stride = params.Trajectory_sampling_stride;
+    Trajectory_sampling_probability = params.Trajectory_sampling_probability;
+    Trajectory_recorder = params.Trajectory_recorder;
     Enable_dynamics_test = params.Enable_dynamics_test;
     Enable_dynamics_extraction = params.Enable_dynamics_extraction;
     Dynamics_initial_exciton_conc = params.Dynamics_initial_exciton_conc;
@@ -120,6 +137,7 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
     Energy_stdev_donor = params.Energy_stdev_donor;
     Energy_stdev_acceptor = params.Energy_stdev_acceptor;
     Enable_exponential_dos = params.Enable_exponential_dos;
+	Enable_procedural_dos = params.Enable_procedural_dos;
     Energy_urbach_donor = params.Energy_urbach_donor;
     Energy_urbach_acceptor = params.Energy_urbach_acceptor;
 	Enable_correlated_disorder = params.Enable_correlated_disorder;
@@ -127,6 +145,7 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
 	Enable_gaussian_kernel = params.Enable_gaussian_kernel;
 	Enable_power_kernel = params.Enable_power_kernel;
 	Power_kernel_exponent = params.Power_kernel_exponent;
+	Enable_direct_convolution = params.Enable_direct_convolution;
     // Coulomb Calculation Parameters
     Dielectric_donor = params.Dielectric_donor;
     Dielectric_acceptor = params.Dielectric_acceptor;
@@ -136,6 +155,15 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
     // Initialize Sites
     Site_OSC site;
     sites.assign(lattice.getNumSites(),site);
+	// Imported morphologies may provide site types in shared memory, which are then used in place of the local site type data
+	if (Enable_import_morphology && Shared_site_types != nullptr) {
+		site_type_data.clear();
+		site_types = Shared_site_types;
+	}
+	else {
+		site_type_data.assign(lattice.getNumSites(), 0);
+		site_types = site_type_data.data();
+	}
     // Initialize Film Architecture
     success = initializeArchitecture();
 	if (!success) {
@@ -144,8 +172,33 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
 		setErrorMessage("Error initializing the film architecture.");
 		return false;
 	}
+	// Identify the sites that are within the exciton dissociation cutoff of the donor/acceptor interface
+	if (Previous_sim != nullptr) {
+		site_interface_flags = Previous_sim->site_interface_flags;
+		N_interface_pairs = Previous_sim->N_interface_pairs;
+		N_donor_interface_sites = Previous_sim->N_donor_interface_sites;
+		N_acceptor_interface_sites = Previous_sim->N_acceptor_interface_sites;
+	}
+	else {
+		calculateInterfaceData();
+	}
+	// Initialize the lists of unoccupied sites used for exciton and time-of-flight polaron creation
+	initializeFreeSites();
+    // Initialize electrical potential vector
+    E_potential.assign(lattice.getHeight(),0);
+    for(int i=0;i<lattice.getHeight();i++){
+        E_potential[i] = (Internal_potential*lattice.getHeight()/(lattice.getHeight()+1))-(Internal_potential/(lattice.getHeight()+1))*i;
+    }
 	// Assign energies to each site in the sites vector
-	reassignSiteEnergies();
+	if (Previous_sim != nullptr && Enable_site_energy_reuse) {
+		Landscape_seed = Previous_sim->Landscape_seed;
+		site_energies_donor = Previous_sim->site_energies_donor;
+		site_energies_acceptor = Previous_sim->site_energies_acceptor;
+		assignSiteEnergies();
+	}
+	else {
+		reassignSiteEnergies();
+	}
     // Initialize Coulomb interactions lookup table
     double avgDielectric = (Dielectric_donor+Dielectric_acceptor)/2;
 	double Unit_size = lattice.getUnitSize();
@@ -157,16 +210,14 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
             Coulomb_table[i] *= erf((Unit_size*sqrt((double)i))/(Polaron_delocalization_length*sqrt(2)));
         }
     }
-    // Initialize electrical potential vector
-    E_potential.assign(lattice.getHeight(),0);
-    for(int i=0;i<lattice.getHeight();i++){
-        E_potential[i] = (Internal_potential*lattice.getHeight()/(lattice.getHeight()+1))-(Internal_potential/(lattice.getHeight()+1))*i;
-    }
     // Initialize exciton creation event
     R_exciton_generation_donor = ((Exciton_generation_rate_donor*N_donor_sites*1e-7*lattice.getUnitSize())*1e-7*lattice.getUnitSize())*1e-7*lattice.getUnitSize();
     R_exciton_generation_acceptor = ((Exciton_generation_rate_acceptor*N_acceptor_sites*1e-7*lattice.getUnitSize())*1e-7*lattice.getUnitSize())*1e-7*lattice.getUnitSize();
     if(Enable_exciton_diffusion_test || Enable_IQE_test){
         isLightOn = true;
+		if (Enable_exciton_diffusion_test) {
+			diffusion_stats.init(Log_Bins(), Raw_data_sample_size, (Raw_data_sample_size > 0) ? (unsigned int)generator() : 0);
+		}
 		Simulation* sim_ptr = this;
 		Exciton_Creation exciton_creation_event(sim_ptr);
         exciton_creation_event.calculateExecutionTime(R_exciton_generation_donor+R_exciton_generation_acceptor);
@@ -178,10 +229,9 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
         // Initialize data structures
         double step_size = 1.0/(double)Transient_pnts_per_decade;
         int num_steps = (int)floor((log10(Transient_end)-log10(Transient_start))/step_size)+1;
-        transient_times.assign(num_steps,0);
-        for(int i=0;i<(int)transient_times.size();i++){
-            transient_times[i] = pow(10,log10(Transient_start)+i*step_size);
-        }
+        // Each time bin extends half a step on either side of its time point on the log scale
+        transient_bins = Log_Bins(Transient_start, Transient_pnts_per_decade, num_steps);
+        transient_times = transient_bins.getBinCenters();
         transient_singlet_counts.assign(num_steps,0);
 		transient_triplet_counts.assign(num_steps, 0);
         transient_electron_counts.assign(num_steps,0);
@@ -200,11 +250,13 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
         // Initialize data structures
         double step_size = 1.0/(double)Transient_pnts_per_decade;
         int num_steps = (int)floor((log10(Transient_end)-log10(Transient_start))/step_size)+1;
-        transient_times.assign(num_steps,0);
-        for(int i=0;i<(int)transient_times.size();i++){
-            transient_times[i] = pow(10,log10(Transient_start)+i*step_size);
-        }
+        // Each time bin extends half a step on either side of its time point on the log scale
+        transient_bins = Log_Bins(Transient_start, Transient_pnts_per_decade, num_steps);
+        transient_times = transient_bins.getBinCenters();
         transient_velocities.assign(num_steps,0);
+		// Transit times are counted in histogram bins that are aligned with the transient time bins
+		transit_time_stats.init(transient_bins, Raw_data_sample_size, (Raw_data_sample_size > 0) ? (unsigned int)generator() : 0);
+		mobility_stats.init(Log_Bins(), 0, 0);
 		if (!ToF_polaron_type) {
 			transient_electron_energies.assign(num_steps, 0);
 			transient_electron_counts.assign(num_steps, 0);
@@ -230,6 +282,94 @@ bool OSC_Sim::init(const Parameters_OPV& params,const int id){
 	}
 }
 
+void OSC_Sim::addTests(const int N_tests_added) {
+	// Extends a finished or running test so that more excitons or polarons are tested before the simulation is finished
+	N_tests += N_tests_added;
+}
+
+bool OSC_Sim::assignMorphologySiteTypes(const Morphology_Header& header, const unsigned char* packed_types) {
+	if (lattice.getLength() != header.length || lattice.getWidth() != header.width || lattice.getHeight() != header.height) {
+		cout << getId() << ": Error! Morphology lattice dimensions do not match the lattice dimensions defined in the parameter file." << endl;
+		setErrorMessage("Morphology lattice dimensions do not match the lattice dimensions defined in the parameter file.");
+		Error_found = true;
+		return false;
+	}
+	// Site types are packed in site index order and are only unpacked when they are not already available in shared memory
+	if (site_types != Shared_site_types) {
+		for (long int n = 0, nmax = (long int)sites.size(); n < nmax; n++) {
+			setSiteType(n, Morphology::getPackedType(packed_types, header.bits_per_site, n));
+		}
+	}
+	for (long int n = 0, nmax = (long int)sites.size(); n < nmax; n++) {
+		short type = getSiteType(n);
+		if (type == (short)1) {
+			N_donor_sites++;
+		}
+		else if (type == (short)2) {
+			N_acceptor_sites++;
+		}
+		// Check for unassigned sites
+		else if (type == (short)0) {
+			cout << getId() << ": Error! Unassigned site found after morphology import. Check the morphology file for errors." << endl;
+			setErrorMessage("Unassigned site found after morphology import. Check the morphology file for errors.");
+			Error_found = true;
+			return false;
+		}
+	}
+	return true;
+}
+
+void OSC_Sim::assignSiteEnergies() {
+	// Procedural site energies are calculated from the landscape seed when needed and are not assigned to the sites
+	if (Enable_procedural_dos) {
+		updateEffectiveSiteEnergies();
+		return;
+	}
+	int donor_count = 0;
+	int acceptor_count = 0;
+	for (int i = 0; i < lattice.getNumSites(); i++) {
+		if (Enable_gaussian_dos || Enable_exponential_dos) {
+			if (getSiteType(i) == (short)1) {
+				sites[i].setEnergyIt(site_energies_donor.begin() + donor_count);
+				donor_count++;
+			}
+			else if (getSiteType(i) == (short)2) {
+				sites[i].setEnergyIt(site_energies_acceptor.begin() + acceptor_count);
+				acceptor_count++;
+			}
+			else {
+				cout << getId() << ": Error! Undefined site type detected while assigning site energies." << endl;
+				setErrorMessage("Undefined site type detected while assigning site energies.");
+				Error_found = true;
+			}
+		}
+		else {
+			if (getSiteType(i) == (short)1) {
+				sites[i].setEnergyIt(site_energies_donor.begin());
+			}
+			else if (getSiteType(i) == (short)2) {
+				sites[i].setEnergyIt(site_energies_acceptor.begin());
+			}
+			else {
+				cout << getId() << ": Error! Undefined site type detected while assigning site energies." << endl;
+				setErrorMessage("Undefined site type detected while assigning site energies.");
+				Error_found = true;
+			}
+		}
+	}
+	isDOSCorrelationCurrent = false;
+	updateEffectiveSiteEnergies();
+	// Start generating the next energy landscape in the background using a separate generator stream, so the results are reproducible
+	if ((Enable_ToF_test || Enable_dynamics_test) && (Enable_gaussian_dos || Enable_exponential_dos)) {
+		if (!isLandscapeGeneratorSeeded) {
+			generator_landscape.seed(generator());
+			isLandscapeGeneratorSeeded = true;
+		}
+		site_energies_next = async(launch::async, &OSC_Sim::createSiteEnergiesNext, this);
+	}
+	//outputVectorToFile(site_energies_donor, "DOS_data.txt");
+}
+
 double OSC_Sim::calculateCoulomb(const list<Polaron>::const_iterator polaron_it, const Coords& coords) const {
 	static const double avgDielectric = (Dielectric_donor + Dielectric_acceptor) / 2;
 	static const double image_interactions = (Elementary_charge / (16 * Pi*avgDielectric*Vacuum_permittivity))*1e9;
@@ -328,11 +468,94 @@ double OSC_Sim::calculateCoulomb(const bool charge, const Coords& coords) const
 }
 
 double OSC_Sim::calculateDiffusionLength_avg() const{
-    return vector_avg(diffusion_distances);
+    return diffusion_stats.getMean();
 }
 
 double OSC_Sim::calculateDiffusionLength_stdev() const{
-    return vector_stdev(diffusion_distances);
+    return diffusion_stats.getStdev();
+}
+
+void OSC_Sim::calculateCorrelatedEnergiesDirect(const vector<double>& energies, const long int site_start, const long int site_end, const vector<Coords>& offsets, const vector<double>& weights, const vector<int>& shell_indices, const int N_shells, vector<double>& new_energies) {
+	int N_offsets = (int)offsets.size();
+	vector<double> energies_temp(N_offsets, 0.0);
+	vector<bool> isAble(N_offsets, false);
+	vector<double> counts(N_shells, 0.0);
+	for (long int n = site_start; n < site_end; n++) {
+		Coords coords = lattice.getSiteCoords(n);
+		counts.assign(N_shells, 0.0);
+		// Get nearby site energies and determine if able
+		for (int m = 0; m < N_offsets; m++) {
+			isAble[m] = lattice.checkMoveValidity(coords, offsets[m].x, offsets[m].y, offsets[m].z);
+			if (isAble[m]) {
+				Coords dest_coords;
+				lattice.calculateDestinationCoords(coords, offsets[m].x, offsets[m].y, offsets[m].z, dest_coords);
+				energies_temp[m] = energies[lattice.getSiteIndex(dest_coords)] * weights[m];
+				counts[shell_indices[m]] += 1.0;
+			}
+		}
+		// Normalize energies by site count
+		new_energies[n] = energies[n];
+		for (int m = 0; m < N_offsets; m++) {
+			if (isAble[m]) {
+				new_energies[n] += energies_temp[m] / counts[shell_indices[m]];
+			}
+		}
+	}
+}
+
+vector<double> OSC_Sim::calculateCorrelatedEnergiesFFT(const vector<double>& energies, const vector<double>& kernel_weights, const int range) {
+	int Length = lattice.getLength();
+	int Width = lattice.getWidth();
+	int Height = lattice.getHeight();
+	int dim = 2 * range + 1;
+	// Non-periodic dimensions are zero padded by at least the kernel range so that the circular convolution does not wrap across the boundary
+	int Nx = lattice.isXPeriodic() ? Length : FFT::nextPowerOfTwo(Length + range);
+	int Ny = lattice.isYPeriodic() ? Width : FFT::nextPowerOfTwo(Width + range);
+	int Nz = lattice.isZPeriodic() ? Height : FFT::nextPowerOfTwo(Height + range);
+	long int grid_size = (long int)Nx*Ny*Nz;
+	// The real part holds the site energies and the imaginary part holds the site occupancy mask, so both are convolved with the real kernel in one pass
+	vector<complex<double>> data(grid_size, complex<double>(0.0, 0.0));
+	for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
+		Coords coords = lattice.getSiteCoords(n);
+		data[((long int)coords.x*Ny + coords.y)*Nz + coords.z] = complex<double>(energies[n], 1.0);
+	}
+	// Kernel offsets larger than a periodic dimension alias onto the same site, matching the direct method
+	vector<complex<double>> kernel(grid_size, complex<double>(0.0, 0.0));
+	double weight_total = 0;
+	for (int i = -range; i <= range; i++) {
+		for (int j = -range; j <= range; j++) {
+			for (int k = -range; k <= range; k++) {
+				double weight = kernel_weights[(i + range)*dim*dim + (j + range)*dim + (k + range)];
+				if (weight == 0) {
+					continue;
+				}
+				int x = ((i % Nx) + Nx) % Nx;
+				int y = ((j % Ny) + Ny) % Ny;
+				int z = ((k % Nz) + Nz) % Nz;
+				kernel[((long int)x*Ny + y)*Nz + z] += weight;
+				weight_total += weight;
+			}
+		}
+	}
+	FFT::transform3D(data, Nx, Ny, Nz, false, N_threads);
+	FFT::transform3D(kernel, Nx, Ny, Nz, false, N_threads);
+	for (long int m = 0; m < grid_size; m++) {
+		data[m] *= kernel[m];
+	}
+	kernel.clear();
+	kernel.shrink_to_fit();
+	FFT::transform3D(data, Nx, Ny, Nz, true, N_threads);
+	// Near non-periodic boundaries, the contribution of the missing neighbors is compensated by renormalizing the available kernel weight
+	vector<double> new_energies(sites.size(), 0.0);
+	for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
+		Coords coords = lattice.getSiteCoords(n);
+		complex<double> result = data[((long int)coords.x*Ny + coords.y)*Nz + coords.z];
+		new_energies[n] = energies[n];
+		if (result.imag() > 1e-12*weight_total) {
+			new_energies[n] += result.real()*(weight_total / result.imag());
+		}
+	}
+	return new_energies;
 }
 
 vector<pair<double,double>> OSC_Sim::calculateDOSCorrelation(const double cutoff_radius) {
@@ -342,20 +565,69 @@ vector<pair<double,double>> OSC_Sim::calculateDOSCorrelation(const double cutoff
 	vector<double> count_total(size, 0.0);
 	vector<double> energies(sites.size());
 	for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
-		Coords coords = lattice.getSiteCoords(n);
-		energies[n] = getSiteEnergy(coords);
+		energies[n] = getSiteEnergy(lattice.getSiteCoords(n));
+	}
+	if (!Enable_direct_convolution) {
+		// The energy-energy and site pair sums for every offset are obtained from the power spectrum using the Wiener-Khinchin theorem
+		int Length = lattice.getLength();
+		int Width = lattice.getWidth();
+		int Height = lattice.getHeight();
+		int Nx = lattice.isXPeriodic() ? Length : FFT::nextPowerOfTwo(Length + range);
+		int Ny = lattice.isYPeriodic() ? Width : FFT::nextPowerOfTwo(Width + range);
+		int Nz = lattice.isZPeriodic() ? Height : FFT::nextPowerOfTwo(Height + range);
+		long int grid_size = (long int)Nx*Ny*Nz;
+		// The real part holds the site energies and the imaginary part holds the site occupancy mask
+		vector<complex<double>> data(grid_size, complex<double>(0.0, 0.0));
+		for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
+			Coords coords = lattice.getSiteCoords(n);
+			data[((long int)coords.x*Ny + coords.y)*Nz + coords.z] = complex<double>(energies[n], 1.0);
+		}
+		FFT::transform3D(data, Nx, Ny, Nz, false, N_threads);
+		// Separate the transforms of the two real inputs and combine their power spectra into one complex array
+		vector<complex<double>> spectra(grid_size);
+		for (int x = 0; x < Nx; x++) {
+			for (int y = 0; y < Ny; y++) {
+				for (int z = 0; z < Nz; z++) {
+					complex<double> Z = data[((long int)x*Ny + y)*Nz + z];
+					complex<double> Z_conj = conj(data[((long int)((Nx - x) % Nx)*Ny + (Ny - y) % Ny)*Nz + (Nz - z) % Nz]);
+					complex<double> F_energy = 0.5*(Z + Z_conj);
+					complex<double> F_mask = complex<double>(0.0, -0.5)*(Z - Z_conj);
+					spectra[((long int)x*Ny + y)*Nz + z] = complex<double>(norm(F_energy), norm(F_mask));
+				}
+			}
+		}
+		data.clear();
+		data.shrink_to_fit();
+		FFT::transform3D(spectra, Nx, Ny, Nz, true, N_threads);
 		for (int i = -range; i <= range; i++) {
 			for (int j = -range; j <= range; j++) {
 				for (int k = -range; k <= range; k++) {
-					if (!lattice.checkMoveValidity(coords, i, j, k)) {
-						continue;
-					}
-					Coords dest_coords;
-					lattice.calculateDestinationCoords(coords, i, j, k, dest_coords);
 					int distance_sq_lat = i*i + j*j + k*k;
 					if (distance_sq_lat < size) {
-						sum_total[distance_sq_lat] += getSiteEnergy(coords)*getSiteEnergy(dest_coords);
-						count_total[distance_sq_lat] += 1.0;
+						complex<double> result = spectra[((long int)(((i % Nx) + Nx) % Nx)*Ny + ((j % Ny) + Ny) % Ny)*Nz + ((k % Nz) + Nz) % Nz];
+						sum_total[distance_sq_lat] += result.real();
+						count_total[distance_sq_lat] += round(result.imag());
+					}
+				}
+			}
+		}
+	}
+	else {
+		for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
+			Coords coords = lattice.getSiteCoords(n);
+			for (int i = -range; i <= range; i++) {
+				for (int j = -range; j <= range; j++) {
+					for (int k = -range; k <= range; k++) {
+						if (!lattice.checkMoveValidity(coords, i, j, k)) {
+							continue;
+						}
+						Coords dest_coords;
+						lattice.calculateDestinationCoords(coords, i, j, k, dest_coords);
+						int distance_sq_lat = i*i + j*j + k*k;
+						if (distance_sq_lat < size) {
+							sum_total[distance_sq_lat] += getSiteEnergy(coords)*getSiteEnergy(dest_coords);
+							count_total[distance_sq_lat] += 1.0;
+						}
 					}
 				}
 			}
@@ -376,48 +648,100 @@ vector<pair<double,double>> OSC_Sim::calculateDOSCorrelation(const double cutoff
 	return correlation_data;
 }
 
-vector<double> OSC_Sim::calculateMobilities(const vector<double>& transit_times) const {
-	vector<double> mobilities = transit_times;
-	for (int i = 0; i < (int)mobilities.size(); i++) {
-		mobilities[i] = (1e-7*lattice.getUnitSize()*lattice.getHeight()) / (fabs(Internal_potential)*transit_times[i]);
-		mobilities[i] *= 1e-7*lattice.getUnitSize()*lattice.getHeight();
+void OSC_Sim::calculateInterfaceData() {
+	site_interface_flags.assign(lattice.getNumSites(), 0);
+	N_interface_pairs = 0;
+	N_donor_interface_sites = 0;
+	N_acceptor_interface_sites = 0;
+	// Offsets to all sites within the exciton dissociation cutoff
+	static const int range = (int)ceil(Exciton_dissociation_cutoff / lattice.getUnitSize());
+	vector<Coords> offsets;
+	Coords offset;
+	for (int i = -range; i <= range; i++) {
+		for (int j = -range; j <= range; j++) {
+			for (int k = -range; k <= range; k++) {
+				double distance = lattice.getUnitSize()*sqrt((double)(i*i + j*j + k*k));
+				if ((i == 0 && j == 0 && k == 0) || (distance - 0.0001) > Exciton_dissociation_cutoff) {
+					continue;
+				}
+				offset.setXYZ(i, j, k);
+				offsets.push_back(offset);
+			}
+		}
+	}
+	Coords coords, dest_coords;
+	for (long int n = 0, nmax = lattice.getNumSites(); n < nmax; n++) {
+		coords = lattice.getSiteCoords(n);
+		const short type = getSiteType(n);
+		// Nearest neighbor donor/acceptor pairs are counted once each using the positive lattice directions
+		const int directions[3][3] = { { 1,0,0 },{ 0,1,0 },{ 0,0,1 } };
+		for (int d = 0; d < 3; d++) {
+			if (lattice.checkMoveValidity(coords, directions[d][0], directions[d][1], directions[d][2])) {
+				lattice.calculateDestinationCoords(coords, directions[d][0], directions[d][1], directions[d][2], dest_coords);
+				if (getSiteType(lattice.getSiteIndex(dest_coords)) != type) {
+					N_interface_pairs++;
+				}
+			}
+		}
+		for (auto const &item : offsets) {
+			if (!lattice.checkMoveValidity(coords, item.x, item.y, item.z)) {
+				continue;
+			}
+			lattice.calculateDestinationCoords(coords, item.x, item.y, item.z, dest_coords);
+			if (getSiteType(lattice.getSiteIndex(dest_coords)) != type) {
+				site_interface_flags[n] = 1;
+				break;
+			}
+		}
+		if (site_interface_flags[n] != 0) {
+			if (type == (short)1) {
+				N_donor_interface_sites++;
+			}
+			else if (type == (short)2) {
+				N_acceptor_interface_sites++;
+			}
+		}
 	}
-	return mobilities;
 }
 
-double OSC_Sim::calculateMobility_avg() const {
-	auto mobilities = calculateMobilities(transit_times);
-	return vector_avg(mobilities);
+double OSC_Sim::calculateIsingUnlikeWeight(const vector<unsigned char>& types, const Coords& coords, const Coords& coords_partner, const unsigned char type, const vector<Coords>& neighbor_offsets, const vector<double>& neighbor_weights, double& weight_total) const {
+	double weight_unlike = 0;
+	weight_total = 0;
+	Coords dest_coords;
+	for (int n = 0, nmax = (int)neighbor_offsets.size(); n < nmax; n++) {
+		if (!lattice.checkMoveValidity(coords, neighbor_offsets[n].x, neighbor_offsets[n].y, neighbor_offsets[n].z)) {
+			continue;
+		}
+		lattice.calculateDestinationCoords(coords, neighbor_offsets[n].x, neighbor_offsets[n].y, neighbor_offsets[n].z, dest_coords);
+		if (dest_coords == coords_partner) {
+			continue;
+		}
+		weight_total += neighbor_weights[n];
+		if (types[lattice.getSiteIndex(dest_coords)] != type) {
+			weight_unlike += neighbor_weights[n];
+		}
+	}
+	return weight_unlike;
 }
 
-double OSC_Sim::calculateMobility_stdev() const {
-	auto mobilities = calculateMobilities(transit_times);
-	return vector_stdev(mobilities);
+double OSC_Sim::calculateMobility_avg() const {
+	return mobility_stats.getMean();
 }
 
-vector<double> OSC_Sim::calculateTransitTimeDist(const vector<double>& data,const int counts) const{
-    double step_size = 1.0/(double)Transient_pnts_per_decade;
-    vector<double> dist(transient_times.size(),0);
-    for(auto const &item : data){
-        for(int j=0;j<(int)transient_times.size();j++){
-            if(item > pow(10,log10(transient_times[j])-0.5*step_size) && item < pow(10,log10(transient_times[j])+0.5*step_size)){
-                dist[j] += 1.0/counts;
-            }
-        }
-    }
-    return dist;
+double OSC_Sim::calculateMobility_stdev() const {
+	return mobility_stats.getStdev();
 }
 
 double OSC_Sim::calculateTransitTime_avg() const{
-    return vector_avg(transit_times);
+    return transit_time_stats.getMean();
 }
 
 double OSC_Sim::calculateTransitTime_stdev() const{
-    return vector_stdev(transit_times);
+    return transit_time_stats.getStdev();
 }
 
 Coords OSC_Sim::calculateExcitonCreationCoords(){
-    static uniform_real_distribution<double> dist(0.0,R_exciton_generation_donor+R_exciton_generation_acceptor);
+    uniform_real_distribution<double> dist(0.0,R_exciton_generation_donor+R_exciton_generation_acceptor);
     double num = dist(generator);
     short type_target;
     if(num<R_exciton_generation_donor){
@@ -427,20 +751,17 @@ Coords OSC_Sim::calculateExcitonCreationCoords(){
         type_target = 2;
     }
     Coords dest_coords;
-    int N_tries = 0;
-    while(N_tries<(lattice.getHeight()*lattice.getWidth()*lattice.getHeight())){
-        dest_coords = lattice.generateRandomCoords();
-        if(isLoggingEnabled()){
-            *Logfile << "Attempting to create exciton at " << dest_coords.x << "," << dest_coords.y << "," << dest_coords.z << "." << endl;
-        }
-        N_tries++;
-        if(!lattice.isOccupied(dest_coords) && getSiteType(dest_coords)==type_target){
-            return dest_coords;
-        }
+	// An unoccupied site of the target type is chosen directly from the free site list
+	if (free_sites.getNumSites(type_target) == 0) {
+		cout << getId() << ": Error! An empty site for exciton creation could not be found." << endl;
+		setErrorMessage("An empty site for exciton creation could not be found.");
+		Error_found = true;
+		return dest_coords;
+	}
+	dest_coords = lattice.getSiteCoords(free_sites.chooseRandomSite(type_target, generator));
+    if(isLoggingEnabled()){
+        *Logfile << "Creating exciton at " << dest_coords.x << "," << dest_coords.y << "," << dest_coords.z << "." << endl;
     }
-    cout << getId() << ": Error! An empty site for exciton creation could not be found." << endl;
-	setErrorMessage("An empty site for exciton creation could not be found.");
-    Error_found = true;
     return dest_coords;
 }
 
@@ -458,26 +779,27 @@ void OSC_Sim::calculateExcitonEvents(Exciton* exciton_ptr){
 	// Declare static variables
     static const int range = (int)ceil( ((FRET_cutoff>Exciton_dissociation_cutoff) ? (FRET_cutoff):(Exciton_dissociation_cutoff))/ lattice.getUnitSize());
     static const int dim = (2*range+1);
-	static Exciton_Hop hop_event(this);
-    static vector<Exciton_Hop> hops_temp(dim*dim*dim,hop_event);
-	static Exciton_Dissociation diss_event(this);
-    static vector<Exciton_Dissociation> dissociations_temp(dim*dim*dim,diss_event);
-	static Exciton_Exciton_Annihilation eea_event(this);
-	static vector<Exciton_Exciton_Annihilation> exciton_exciton_annihilations_temp(dim*dim*dim,eea_event);
-	static Exciton_Polaron_Annihilation epa_event(this);
-	static vector<Exciton_Polaron_Annihilation> exciton_polaron_annihilations_temp(dim*dim*dim,epa_event);
-    static vector<bool> hops_valid(dim*dim*dim,false);
-    static vector<bool> dissociations_valid(dim*dim*dim,false);
-	static vector<bool> exciton_exciton_annihilations_valid(dim*dim*dim, false);
-	static vector<bool> exciton_polaron_annihilations_valid(dim*dim*dim, false);
+	static const int range_FRET = (int)ceil(FRET_cutoff / lattice.getUnitSize());
+    static thread_local vector<Exciton_Hop> hops_temp;
+    static thread_local vector<Exciton_Dissociation> dissociations_temp;
+	static thread_local vector<Exciton_Exciton_Annihilation> exciton_exciton_annihilations_temp;
+	static thread_local vector<Exciton_Polaron_Annihilation> exciton_polaron_annihilations_temp;
+    static thread_local vector<bool> hops_valid(dim*dim*dim,false);
+    static thread_local vector<bool> dissociations_valid(dim*dim*dim,false);
+	static thread_local vector<bool> exciton_exciton_annihilations_valid(dim*dim*dim, false);
+	static thread_local vector<bool> exciton_polaron_annihilations_valid(dim*dim*dim, false);
 	// pre-calculate a distances vector that contains the distances to nearby sites used for event execution time calculations
 	// pre-calculate isInDissRange and isInFRETRange vectors that contains booleans to indicate whether the nearby sites are within range for the different exciton events to be possible.
-	static vector<double> distances(dim*dim*dim, 0.0);
-	static vector<bool> isInDissRange(dim*dim*dim, false);
-	static vector<bool> isInFRETRange(dim*dim*dim, false);
-	static bool isInitialized = false;
-	// Initiaize static distances, isInDissRange, and isInFRETRange vectors
-	if (!isInitialized) {
+	static thread_local vector<double> distances(dim*dim*dim, 0.0);
+	static thread_local vector<bool> isInDissRange(dim*dim*dim, false);
+	static thread_local vector<bool> isInFRETRange(dim*dim*dim, false);
+	// Initiaize the static temporary events and the distances, isInDissRange, and isInFRETRange vectors
+	// The temporary events point to the simulation object that creates them, so they are thread local and are created again by each new simulation object run in the same thread
+	if (!isExcitonEventsInitialized) {
+		hops_temp.assign(dim*dim*dim, Exciton_Hop(this));
+		dissociations_temp.assign(dim*dim*dim, Exciton_Dissociation(this));
+		exciton_exciton_annihilations_temp.assign(dim*dim*dim, Exciton_Exciton_Annihilation(this));
+		exciton_polaron_annihilations_temp.assign(dim*dim*dim, Exciton_Polaron_Annihilation(this));
 		for (int i = -range; i <= range; i++) {
 			for (int j = -range; j <= range; j++) {
 				for (int k = -range; k <= range; k++) {
@@ -492,18 +814,21 @@ void OSC_Sim::calculateExcitonEvents(Exciton* exciton_ptr){
 				}
 			}
 		}
-		isInitialized = true;
+		isExcitonEventsInitialized = true;
 	}
 	// Exciton hopping, dissociation, and annihilation events
 	hops_valid.assign(dim*dim*dim,false);
 	dissociations_valid.assign(dim*dim*dim, false);
 	exciton_exciton_annihilations_valid.assign(dim*dim*dim, false);
 	exciton_polaron_annihilations_valid.assign(dim*dim*dim, false);
-    for(int i=-range;i<=range;i++){
-        for(int j=-range;j<=range;j++){
-            for(int k=-range;k<=range;k++){
+	// Excitons on sites that are not within the dissociation cutoff of the interface only need to be checked for hopping and annihilation events
+	const bool isNearInterface = (site_interface_flags[lattice.getSiteIndex(object_coords)] != 0);
+	const int scan_range = isNearInterface ? range : min(range, range_FRET);
+    for(int i=-scan_range;i<=scan_range;i++){
+        for(int j=-scan_range;j<=scan_range;j++){
+            for(int k=-scan_range;k<=scan_range;k++){
                 index = (i+range)*dim*dim+(j+range)*dim+(k+range);
-				if (!isInDissRange[index] && !isInFRETRange[index]) {
+				if (!(isInDissRange[index] && isNearInterface) && !isInFRETRange[index]) {
 					continue;
 				}
                 if(!lattice.checkMoveValidity(object_coords,i,j,k)){
@@ -577,7 +902,7 @@ void OSC_Sim::calculateExcitonEvents(Exciton* exciton_ptr){
 				// Dissociation and Hop events
 				else {
 					// Dissociation event
-					if (getSiteType(object_coords) != getSiteType(dest_coords) && isInDissRange[index]) {
+					if (isNearInterface && isInDissRange[index] && getSiteType(object_coords) != getSiteType(dest_coords)) {
 						dissociations_temp[index].setObjectPtr(exciton_ptr);
 						dissociations_temp[index].setDestCoords(dest_coords);
 						// Exciton is starting from a donor site
@@ -832,28 +1157,33 @@ void OSC_Sim::calculatePolaronEvents(Polaron* polaron_ptr){
 		return;
 	}
     Coords dest_coords;
-    //double E_delta;
     int index;
-	double E_site_i = getSiteEnergy(object_coords);
+	const bool charge = polaron_it->getCharge();
+	const short type_i = getSiteType(object_coords);
+	// The effective site energies already include the site energy, the internal potential, and the HOMO/LUMO offsets for the carrier type
+	const double E_effective_i = getEffectiveSiteEnergy(charge, lattice.getSiteIndex(object_coords));
     double Coulomb_i = calculateCoulomb(polaron_it,object_coords);
+	// Hopping parameters are determined by the type of the starting site
+	const double R_hopping = (type_i == (short)1) ? R_polaron_hopping_donor : R_polaron_hopping_acceptor;
+	const double Localization = (type_i == (short)1) ? Polaron_localization_donor : Polaron_localization_acceptor;
+	const double Reorganization = (type_i == (short)1) ? Reorganization_donor : Reorganization_acceptor;
 	vector<Event*> possible_events;
 	// Static obejcts
     static const int range = (int)ceil(Polaron_hopping_cutoff/ lattice.getUnitSize());
     static const int dim = (2*range+1);
-	static Polaron_Hop hop_event(this);
-    static vector<Polaron_Hop> hops_temp(dim*dim*dim,hop_event);
-	static Polaron_Recombination rec_event(this);
-	static vector<Polaron_Recombination> recombinations_temp(dim*dim*dim,rec_event);
-    static vector<bool> hops_valid(dim*dim*dim,false);
-    static vector<bool> recombinations_valid(dim*dim*dim,false);
+    static thread_local vector<Polaron_Hop> hops_temp;
+	static thread_local vector<Polaron_Recombination> recombinations_temp;
+    static thread_local vector<bool> hops_valid(dim*dim*dim,false);
+    static thread_local vector<bool> recombinations_valid(dim*dim*dim,false);
 	// pre-calculate a distances vector that contains the distances to nearby sites used for event execution time calculations
 	// pre-calculate a isInRange vector that contains booleans to indicate if the nearby sites are within range for polaron events to be possible.
-	static vector<double> distances(dim*dim*dim, 0.0);
-	static vector<double> E_deltas(dim*dim*dim, 0.0);
-	static vector<bool> isInRange(dim*dim*dim, false);
-	static bool isInitialized = false;
-	// Intialize static distances and isInRange vectors
-	if (!isInitialized) {
+	static thread_local vector<double> distances(dim*dim*dim, 0.0);
+	static thread_local vector<double> E_deltas(dim*dim*dim, 0.0);
+	static thread_local vector<bool> isInRange(dim*dim*dim, false);
+	// Intialize the static temporary events, which are created again by each new simulation object, and the distances and isInRange vectors
+	if (!isPolaronEventsInitialized) {
+		hops_temp.assign(dim*dim*dim, Polaron_Hop(this));
+		recombinations_temp.assign(dim*dim*dim, Polaron_Recombination(this));
 		for (int i = -range; i <= range; i++) {
 			for (int j = -range; j <= range; j++) {
 				for (int k = -range; k <= range; k++) {
@@ -865,7 +1195,7 @@ void OSC_Sim::calculatePolaronEvents(Polaron* polaron_ptr){
 				}
 			}
 		}
-		isInitialized = true;
+		isPolaronEventsInitialized = true;
 	}
 	// Calculate Polaron hopping and recombination events
 	hops_valid.assign(dim*dim*dim, false);
@@ -881,15 +1211,11 @@ void OSC_Sim::calculatePolaronEvents(Polaron* polaron_ptr){
 					continue;
 				}
                 lattice.calculateDestinationCoords(object_coords,i,j,k,dest_coords);
+				long int dest_index = lattice.getSiteIndex(dest_coords);
                 // Recombination events
                 // If destination site is occupied by a hole Polaron and the main Polaron is an electron, check for a possible recombination event
-                if(lattice.isOccupied(dest_coords) && !polaron_it->getCharge() && siteContainsHole(dest_coords)){
-                    if(getSiteType(object_coords)==(short)1){
-                        recombinations_temp[index].calculateExecutionTime(R_polaron_recombination,Polaron_localization_donor,distances[index],0);
-                    }
-                    else if(getSiteType(object_coords)==(short)2){
-                        recombinations_temp[index].calculateExecutionTime(R_polaron_recombination,Polaron_localization_acceptor,distances[index],0);
-                    }
+                if(lattice.isOccupied(dest_coords) && !charge && siteContainsHole(dest_coords)){
+                    recombinations_temp[index].calculateExecutionTime(R_polaron_recombination,Localization,distances[index],0);
 					recombinations_temp[index].setObjectPtr(polaron_ptr);
                     recombinations_temp[index].setDestCoords(dest_coords);
                     recombinations_temp[index].setObjectTargetPtr((*lattice.getSiteIt(dest_coords))->getObjectPtr());
@@ -897,46 +1223,13 @@ void OSC_Sim::calculatePolaronEvents(Polaron* polaron_ptr){
                 }
                 // Hop events
                 // If destination site is unoccupied and either phase restriction is disabled or the starting site and destination sites have the same type, check for a possible hop event
-                if(!lattice.isOccupied(dest_coords) && (!Enable_phase_restriction || getSiteType(object_coords)==getSiteType(dest_coords))){
-					E_deltas[index] = (getSiteEnergy(dest_coords) - E_site_i);
-					E_deltas[index] += (calculateCoulomb(polaron_it,dest_coords)-Coulomb_i);
-                    if(!polaron_it->getCharge()){
-                        E_deltas[index] += (E_potential[dest_coords.z]-E_potential[object_coords.z]);
+                if(!lattice.isOccupied(dest_coords) && (!Enable_phase_restriction || type_i==getSiteType(dest_index))){
+					E_deltas[index] = (getEffectiveSiteEnergy(charge, dest_index) - E_effective_i) + (calculateCoulomb(polaron_it,dest_coords) - Coulomb_i);
+                    if(Enable_miller_abrahams){
+                        hops_temp[index].calculateExecutionTime(R_hopping,Localization,distances[index],E_deltas[index]);
                     }
                     else{
-                        E_deltas[index] -= (E_potential[dest_coords.z]-E_potential[object_coords.z]);
-                    }
-                    if(getSiteType(object_coords)==(short)1){
-                        if(getSiteType(dest_coords)==(short)2){
-                            if(!polaron_it->getCharge()){
-                                E_deltas[index] -= (Lumo_acceptor-Lumo_donor);
-                            }
-                            else{
-                                E_deltas[index] -= (Homo_acceptor-Homo_donor);
-                            }
-                        }
-                        if(Enable_miller_abrahams){
-                            hops_temp[index].calculateExecutionTime(R_polaron_hopping_donor,Polaron_localization_donor,distances[index],E_deltas[index]);
-                        }
-                        else{
-                            hops_temp[index].calculateExecutionTime(R_polaron_hopping_donor,Polaron_localization_donor,distances[index],E_deltas[index],Reorganization_donor);
-                        }
-                    }
-                    else if(getSiteType(object_coords)==(short)2){
-                        if(getSiteType(dest_coords)==(short)1){
-                            if(!polaron_it->getCharge()){
-                                E_deltas[index] -= (Lumo_donor-Lumo_acceptor);
-                            }
-                            else{
-                                E_deltas[index] -= (Homo_donor-Homo_acceptor);
-                            }
-                        }
-                        if(Enable_miller_abrahams){
-                            hops_temp[index].calculateExecutionTime(R_polaron_hopping_acceptor,Polaron_localization_acceptor,distances[index],E_deltas[index]);
-                        }
-                        else{
-                            hops_temp[index].calculateExecutionTime(R_polaron_hopping_acceptor,Polaron_localization_acceptor,distances[index],E_deltas[index],Reorganization_acceptor);
-                        }
+                        hops_temp[index].calculateExecutionTime(R_hopping,Localization,distances[index],E_deltas[index],Reorganization);
                     }
 					hops_temp[index].setObjectPtr(polaron_ptr);
 					hops_temp[index].setDestCoords(dest_coords);
@@ -1050,6 +1343,25 @@ void OSC_Sim::calculatePolaronEvents(Polaron* polaron_ptr){
 	setObjectEvent(polaron_ptr, event_ptr_target);
 }
 
+double OSC_Sim::calculateProceduralSiteEnergy(const long int site_index) const {
+	// Independent uniform random numbers are generated for each site by hashing the site index together with the landscape seed
+	const unsigned long long counter = 3 * (unsigned long long)site_index;
+	const double u1 = hashToUniform(Landscape_seed, counter);
+	const double u2 = hashToUniform(Landscape_seed, counter + 1);
+	const bool isDonor = (getSiteType(site_index) == (short)1);
+	if (Enable_gaussian_dos) {
+		// Box-Muller transform
+		return (isDonor ? Energy_stdev_donor : Energy_stdev_acceptor)*sqrt(-2.0*log(u1))*cos(2.0*Pi*u2);
+	}
+	// The exponential DOS is exponential below the mode and Gaussian above it, with the standard deviation chosen so that the distribution is continuous at the mode
+	const double urbach_energy = isDonor ? Energy_urbach_donor : Energy_urbach_acceptor;
+	const double u3 = hashToUniform(Landscape_seed, counter + 2);
+	if (u3 < 0.5) {
+		return urbach_energy*log(u1);
+	}
+	return urbach_energy*sqrt(2.0 / Pi)*fabs(sqrt(-2.0*log(u1))*cos(2.0*Pi*u2));
+}
+
 bool OSC_Sim::checkFinished() const{
     if(Error_found){
         cout << getId() << ": An error has been detected and the simulation will now end." << endl;
@@ -1091,6 +1403,10 @@ bool OSC_Sim::checkParameters(const Parameters_OPV& params) const {
 		cout << "Error! The temperature must be greater than zero." << endl;
 		return false;
 	}
+	if (!(params.N_threads > 0)) {
+		cout << "Error! The number of threads must be greater than zero." << endl;
+		return false;
+	}
 	int KMC_algs = 0;
 	if (params.Enable_FRM) {
 		KMC_algs++;
@@ -1126,10 +1442,23 @@ bool OSC_Sim::checkParameters(const Parameters_OPV& params) const {
 		cout << "Error! When using the bilayer film architecture, the sum of the donor and the acceptor thicknesses must equal the lattice height." << endl;
 		return false;
 	}
+	if (params.Enable_ising_blend && !(params.Acceptor_conc > 0 && params.Acceptor_conc < 1)) {
+		cout << "Error! When using the Ising blend film architecture, the acceptor concentration must be greater than zero and less than one." << endl;
+		return false;
+	}
+	if (params.Enable_ising_blend && (params.Ising_interaction_energy < 0 || params.Ising_MC_steps < 0)) {
+		cout << "Error! When using the Ising blend film architecture, the interaction energy and the number of Monte Carlo steps cannot be negative." << endl;
+		return false;
+	}
+	if (params.Enable_ising_blend && (params.Ising_smoothing_threshold < 0 || params.Ising_smoothing_threshold >= 1)) {
+		cout << "Error! When using the Ising blend film architecture, the smoothing threshold must be greater than or equal to zero and less than one." << endl;
+		return false;
+	}
 	// Possible device architectures:
 	// Neat
 	// Bilayer
 	// Random Blend
+	// Ising Blend
 	// Import morphology
 	int N_architectures_enabled = 0;
 	if (params.Enable_neat) {
@@ -1141,6 +1470,9 @@ bool OSC_Sim::checkParameters(const Parameters_OPV& params) const {
 	if (params.Enable_random_blend) {
 		N_architectures_enabled++;
 	}
+	if (params.Enable_ising_blend) {
+		N_architectures_enabled++;
+	}
 	if (params.Enable_import_morphology) {
 		N_architectures_enabled++;
 	}
@@ -1173,6 +1505,26 @@ bool OSC_Sim::checkParameters(const Parameters_OPV& params) const {
 		cout << "Error! The number of tests must be greater than zero." << endl;
 		return false;
 	}
+	if (params.Raw_data_sample_size < 0) {
+		cout << "Error! The raw data sample size cannot be negative." << endl;
+		return false;
+	}
+	if (params.Enable_trajectory_recording && params.Trajectory_recorder == nullptr) {
+		cout << "Error! Trajectory recording is enabled, but no trajectory recorder was provided." << endl;
+		return false;
+	}
+	if (params.Enable_trajectory_recording && !(params.Trajectory_species_mask > 0)) {
+		cout << "Error! At least one trajectory species must be selected when trajectory recording is enabled." << endl;
+		return false;
+	}
+	if (!(params.Trajectory_sampling_stride > 0)) {
+		cout << "Error! The trajectory sampling stride must be greater than zero." << endl;
+		return false;
+	}
+	if (!(params.Trajectory_sampling_probability > 0) || params.Trajectory_sampling_probability > 1) {
+		cout << "Error! The trajectory sampling probability must be greater than zero and less than or equal to one." << endl;
+		return false;
+	}
 	// Possible simulation tests:
 	// Exciton diffusion test
 	// ToF test
@@ -1329,6 +1681,14 @@ bool OSC_Sim::checkParameters(const Parameters_OPV& params) const {
 		cout << "Error! When using the Gaussian disorder model, the standard deviation cannot be negative." << endl;
 		return false;
 	}
+	if (params.Enable_procedural_dos && !params.Enable_gaussian_dos && !params.Enable_exponential_dos) {
+		cout << "Error! The procedural DOS model requires either the Gaussian or the exponential density of states to be enabled." << endl;
+		return false;
+	}
+	if (params.Enable_procedural_dos && params.Enable_correlated_disorder) {
+		cout << "Error! The procedural DOS model cannot be used with the correlated disorder model." << endl;
+		return false;
+	}
 	if (params.Enable_exponential_dos && (params.Energy_urbach_donor < 0 || params.Energy_urbach_acceptor < 0)) {
 		cout << "Error! When using the exponential disorder model, the Urbach energy cannot be negative." << endl;
 		return false;
@@ -1372,12 +1732,9 @@ bool OSC_Sim::checkParameters(const Parameters_OPV& params) const {
 	return true;
 }
 
-void OSC_Sim::createCorrelatedDOS(const double correlation_length) {
-	int range;
-	double stdev, percent_diff;
-	double distance_max = 0;
-	double scale_factor = 1;
-	double Unit_size = lattice.getUnitSize();
+void OSC_Sim::calculateCorrelationKernelParams(const double correlation_length, double& distance_max, double& scale_factor) const {
+	distance_max = 0;
+	scale_factor = 1;
 	if (Enable_gaussian_kernel) {
 		distance_max = 1 + 1.8*correlation_length;
 		scale_factor = -0.1 - 1.21*pow(correlation_length, -2.87);
@@ -1391,6 +1748,14 @@ void OSC_Sim::createCorrelatedDOS(const double correlation_length) {
 		scale_factor = -0.4 + 2.2*pow(correlation_length, -0.74);
 		scale_factor = pow(scale_factor, 2);
 	}
+}
+
+void OSC_Sim::createCorrelatedDOS(const double correlation_length, vector<double>& energies_donor, vector<double>& energies_acceptor) {
+	int range;
+	double stdev, percent_diff;
+	double distance_max, scale_factor;
+	double Unit_size = lattice.getUnitSize();
+	calculateCorrelationKernelParams(correlation_length, distance_max, scale_factor);
 	// Create and calculates distances and range check vectors
 	range = (int)ceil(distance_max / Unit_size);
 	int dim = 2 * range + 1;
@@ -1413,62 +1778,84 @@ void OSC_Sim::createCorrelatedDOS(const double correlation_length) {
 			}
 		}
 	}
-	// Impart correlation
-	vector<double> new_energies((int)sites.size(), 0.0);
-	vector<double> isAble(vec_size, 0.0);
-	vector<double> energies_temp(vec_size, 0.0);
-	vector<double> counts((int)ceil((distance_max / Unit_size)*(distance_max / Unit_size)) + 1, 0.0);
-	for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
-		isAble.assign(vec_size, 0.0);
-		energies_temp.assign(vec_size, 0.0);
-		Coords coords = lattice.getSiteCoords(n);
-		// Get nearby site energies and determine if able
-		#pragma loop(hint_parallel(2))
-		#pragma loop(ivdep)
-		for (int i = -range; i <= range; i++) {
-			for (int j = -range; j <= range; j++) {
-				for (int k = -range; k <= range; k++) {
-					if (!lattice.checkMoveValidity(coords, i, j, k)) {
-						continue;
-					}
-					Coords dest_coords;
-					lattice.calculateDestinationCoords(coords, i, j, k, dest_coords);
-					int index = (i + range)*dim*dim + (j + range)*dim + (k + range);
-					if (isInRange[index]) {
-						energies_temp[index] = getSiteEnergy(dest_coords);
-						isAble[index] = 1.0;
-					}
-				}
-			}
+	// Calculate the kernel value for each offset within range
+	vector<double> kernel_values(vec_size, 0.0);
+	int N_shells = (int)ceil((distance_max / Unit_size)*(distance_max / Unit_size)) + 1;
+	for (int m = 0; m < vec_size; m++) {
+		if (!isInRange[m] || distance_indices[m] >= N_shells) {
+			continue;
 		}
 		if (Enable_gaussian_kernel) {
-			for (int m = 0; m < vec_size; m++) {
-				energies_temp[m] = isAble[m] * energies_temp[m] * exp(scale_factor * distances[m] * distances[m]);
-			}
+			kernel_values[m] = exp(scale_factor * distances[m] * distances[m]);
 		}
 		if (Enable_power_kernel && Power_kernel_exponent == -1) {
-			for (int m = 0; m < vec_size; m++) {
-				energies_temp[m] = isAble[m] * energies_temp[m] / (scale_factor * distances[m]);
-			}
+			kernel_values[m] = 1.0 / (scale_factor * distances[m]);
 		}
 		if (Enable_power_kernel && Power_kernel_exponent == -2) {
-			for (int m = 0; m < vec_size; m++) {
-				energies_temp[m] = isAble[m] * energies_temp[m] / (scale_factor * distances[m] * distances[m]);
-			}
+			kernel_values[m] = 1.0 / (scale_factor * distances[m] * distances[m]);
 		}
-		// Normalize energies by site count
-		counts.assign((int)ceil((distance_max / Unit_size)*(distance_max / Unit_size)) + 1, 0.0);
+	}
+	// Gather the uncorrelated energies in site order
+	vector<double> energies(sites.size(), 0.0);
+	int donor_count = 0;
+	int acceptor_count = 0;
+	for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
+		if (getSiteType(n) == (short)1) {
+			energies[n] = energies_donor[donor_count];
+			donor_count++;
+		}
+		else if (getSiteType(n) == (short)2) {
+			energies[n] = energies_acceptor[acceptor_count];
+			acceptor_count++;
+		}
+	}
+	// Impart correlation
+	vector<double> new_energies(sites.size(), 0.0);
+	if (!Enable_direct_convolution) {
+		// Normalize the kernel by the number of sites at each distance in the full kernel window
+		vector<double> counts(N_shells, 0.0);
 		for (int m = 0; m < vec_size; m++) {
-			if (isAble[m] > 0.1 && distance_indices[m] < (int)counts.size()) {
+			if (kernel_values[m] != 0) {
 				counts[distance_indices[m]] += 1.0;
 			}
 		}
 		for (int m = 0; m < vec_size; m++) {
-			if (isAble[m] > 0.1 && distance_indices[m] < (int)counts.size()) {
-				energies_temp[m] /= counts[distance_indices[m]];
+			if (kernel_values[m] != 0) {
+				kernel_values[m] /= counts[distance_indices[m]];
 			}
 		}
-		new_energies[n] = accumulate(energies_temp.begin(), energies_temp.end(), getSiteEnergy(coords));
+		new_energies = calculateCorrelatedEnergiesFFT(energies, kernel_values, range);
+	}
+	else {
+		// Construct the list of kernel offsets within range
+		vector<Coords> offsets;
+		vector<double> weights;
+		vector<int> shell_indices;
+		for (int i = -range; i <= range; i++) {
+			for (int j = -range; j <= range; j++) {
+				for (int k = -range; k <= range; k++) {
+					int index = (i + range)*dim*dim + (j + range)*dim + (k + range);
+					if (kernel_values[index] != 0) {
+						Coords offset;
+						offset.setXYZ(i, j, k);
+						offsets.push_back(offset);
+						weights.push_back(kernel_values[index]);
+						shell_indices.push_back(distance_indices[index]);
+					}
+				}
+			}
+		}
+		// Each thread calculates a contiguous block of sites, so the result does not depend on the number of threads
+		long int N_sites = (long int)sites.size();
+		int N_workers = (int)min((long int)N_threads, N_sites);
+		vector<thread> workers;
+		for (int t = 1; t < N_workers; t++) {
+			workers.push_back(thread(&OSC_Sim::calculateCorrelatedEnergiesDirect, this, cref(energies), (t*N_sites) / N_workers, ((t + 1)*N_sites) / N_workers, cref(offsets), cref(weights), cref(shell_indices), N_shells, ref(new_energies)));
+		}
+		calculateCorrelatedEnergiesDirect(energies, 0, N_sites / N_workers, offsets, weights, shell_indices, N_shells, new_energies);
+		for (auto& worker : workers) {
+			worker.join();
+		}
 	}
 	// Normalize energies to reach desired disorder
 	stdev = vector_stdev(new_energies);
@@ -1477,108 +1864,115 @@ void OSC_Sim::createCorrelatedDOS(const double correlation_length) {
 	for (auto &item : new_energies) {
 		item /= norm_factor;
 	}
-	// Assign new energies to the sites
-	for (int n = 0; n < (int)sites.size(); n++) {
-		sites[n].setEnergy(new_energies[n]);
+	// Scatter the new energies back in site order
+	donor_count = 0;
+	acceptor_count = 0;
+	for (int n = 0, nmax = (int)sites.size(); n < nmax; n++) {
+		if (getSiteType(n) == (short)1) {
+			energies_donor[donor_count] = new_energies[n];
+			donor_count++;
+		}
+		else if (getSiteType(n) == (short)2) {
+			energies_acceptor[acceptor_count] = new_energies[n];
+			acceptor_count++;
+		}
 	}
-	// Calculate the correlation function
-	DOS_correlation_data = calculateDOSCorrelation(distance_max);
 }
 
 bool OSC_Sim::createImportedMorphology(){
-    string file_info;
-    string line;
-    stringstream ss;
-    Coords coords;
-    short type = 0;
-    int length,width,height;
-    int site_count = 0;
-	bool isV3 = false;
-	bool isV4 = false;
-    // Get input morphology file information
-    getline(*Morphology_file,line);
-    file_info = line;
-    // Parse file info
-	if (file_info.find("Ising_OPV v3.2 - compressed format") != string::npos) {
-		isV3 = true;
-	}
-	else if (file_info.find("Ising_OPV v4.0") != string::npos && file_info.find("compressed")!=string::npos && file_info.find("uncompressed") == string::npos) {
-		isV4 = true;
-	}
-    else {
-        cout << getId() << ": Error! Morphology file format not recognized. Only compressed morphologies created using Ising_OPV v3.2 and v4.0 are currently supported." << endl;
-		setErrorMessage("Morphology file format not recognized. Only compressed morphologies created using Ising_OPV v3.2 and v4.0 are currently supported.");
-        Error_found = true;
-        return false;
-    }
-    getline(*Morphology_file,line);
-    length = atoi(line.c_str());
-    getline(*Morphology_file,line);
-    width = atoi(line.c_str());
-    getline(*Morphology_file,line);
-    height = atoi(line.c_str());
-    if(lattice.getLength()!=length || lattice.getWidth()!=width || lattice.getHeight()!=height){
-        cout << getId() << ": Error! Morphology lattice dimensions do not match the lattice dimensions defined in the parameter file." << endl;
-		setErrorMessage("Morphology lattice dimensions do not match the lattice dimensions defined in the parameter file.");
-        Error_found = true;
-        return false;
-    }
-	if (isV3) {
-		// Skip 3 lines (domain size1, domain size2, blend ratio)
-		getline(*Morphology_file, line);
-		getline(*Morphology_file, line);
-		getline(*Morphology_file, line);
-	}
-	else if (isV4) {
-		// skip boundary conditions
-		getline(*Morphology_file, line);
-		getline(*Morphology_file, line);
-		getline(*Morphology_file, line);
-		// number of site types
-		getline(*Morphology_file, line);
-		int N_types = atoi(line.c_str());
-		// skip domain size and mix fraction lines
-		for (int i = 0; i < 2 * N_types; i++) {
-			getline(*Morphology_file, line);
-		}
-	}
-    // Begin parsing morphology site data
-	for (int x = 0; x < lattice.getLength(); x++) {
-		for (int y = 0; y < lattice.getWidth(); y++) {
-			for (int z = 0; z < lattice.getHeight(); z++) {
-				if (site_count == 0) {
-					if (!(*Morphology_file).good()) {
-						cout << "Error parsing file.  End of file reached before expected." << endl;
-						setErrorMessage("Error parsing imported morphology file.  End of file reached before expected.");
-						Error_found = true;
-						return false;
-					}
-					getline(*Morphology_file, line);
-					type = (short)atoi(line.substr(0, 1).c_str());
-					site_count = atoi(line.substr(1).c_str());
-				}
-				coords.setXYZ(x, y, z);
-				sites[lattice.getSiteIndex(coords)].setType(type);
-				if (type == (short)1) {
-					N_donor_sites++;
-				}
-				else if (type == (short)2) {
-					N_acceptor_sites++;
+	string error_message;
+	// Morphology data that has already been loaded and distributed by the calling program is used directly
+	if (Morphology_header != nullptr && Morphology_packed_types != nullptr) {
+		return assignMorphologySiteTypes(*Morphology_header, Morphology_packed_types);
+	}
+	// Binary morphology files are mapped into memory and the packed site types are used directly without parsing
+	if (Morphology::isBinaryMorphologyFile(Morphology_filename)) {
+		Morphology_File_Map morphology_map;
+		if (!morphology_map.open(Morphology_filename, error_message)) {
+			cout << getId() << ": Error! " << error_message << endl;
+			setErrorMessage(error_message);
+			Error_found = true;
+			return false;
+		}
+		return assignMorphologySiteTypes(morphology_map.getHeader(), morphology_map.getPackedTypes());
+	}
+	// Compressed text morphology files are parsed and packed first
+	Morphology_Header header;
+	vector<unsigned char> packed_types;
+	if (!Morphology::importCompressedTextMorphology(*Morphology_file, header, packed_types, error_message)) {
+		cout << getId() << ": Error! " << error_message << endl;
+		setErrorMessage(error_message);
+		Error_found = true;
+		return false;
+	}
+	return assignMorphologySiteTypes(header, packed_types.data());
+}
+
+void OSC_Sim::createIsingMorphology() {
+	// The blend starts as a random mixture with the specified acceptor concentration and phase separates through Metropolis Monte Carlo
+	// exchanges of neighboring donor and acceptor sites (Kawasaki dynamics), which conserve the blend ratio
+	site_type_data.assign(lattice.getNumSites(), 1);
+	for (int i = 0; i < (int)lattice.getNumSites()*Acceptor_conc; i++) {
+		site_type_data[i] = 2;
+	}
+	shuffle(site_type_data.begin(), site_type_data.end(), generator);
+	// Interactions with the first, second, and third nearest neighbors are weighted by the inverse distance
+	vector<Coords> neighbor_offsets;
+	vector<double> neighbor_weights;
+	Coords offset;
+	for (int i = -1; i <= 1; i++) {
+		for (int j = -1; j <= 1; j++) {
+			for (int k = -1; k <= 1; k++) {
+				if (i == 0 && j == 0 && k == 0) {
+					continue;
 				}
-				site_count--;
+				offset.setXYZ(i, j, k);
+				neighbor_offsets.push_back(offset);
+				neighbor_weights.push_back(1.0 / sqrt((double)(i*i + j*j + k*k)));
 			}
 		}
 	}
-    // Check for unassigned sites
-    for (auto const &item : sites){
-        if(item.getType()==(short)0){
-            cout << getId() << ": Error! Unassigned site found after morphology import. Check the morphology file for errors." << endl;
-			setErrorMessage("Unassigned site found after morphology import. Check the morphology file for errors.");
-            Error_found = true;
-            return false;
-        }
-    }
-    return true;
+	// The lattice is divided into slabs along the x-direction that are at least 3 sites thick, and the even and odd slabs are updated in alternating
+	// half sweeps.  Exchanges starting in a slab only write to that slab and its boundary sites and only read one site further, so slabs of the same
+	// parity never touch the same sites and can be updated concurrently.  Each slab has its own generator, so the morphology does not depend on the number of threads.
+	int N_slabs = lattice.getLength() / 3;
+	if (N_slabs % 2 != 0) {
+		N_slabs--;
+	}
+	N_slabs = max(N_slabs, 1);
+	vector<mt19937> slab_generators(N_slabs);
+	for (auto& slab_generator : slab_generators) {
+		slab_generator.seed(generator());
+	}
+	for (int step = 0; step < Ising_MC_steps; step++) {
+		for (int parity = 0; parity < min(N_slabs, 2); parity++) {
+			int N_parity_slabs = (N_slabs - parity + 1) / 2;
+			int N_workers = min(N_threads, N_parity_slabs);
+			vector<thread> workers;
+			for (int t = 1; t < N_workers; t++) {
+				workers.push_back(thread(&OSC_Sim::updateIsingSlabs, this, parity + 2 * ((t*N_parity_slabs) / N_workers), parity + 2 * (((t + 1)*N_parity_slabs) / N_workers), N_slabs, ref(slab_generators), cref(neighbor_offsets), cref(neighbor_weights)));
+			}
+			updateIsingSlabs(parity, parity + 2 * (N_parity_slabs / N_workers), N_slabs, slab_generators, neighbor_offsets, neighbor_weights);
+			for (auto& worker : workers) {
+				worker.join();
+			}
+		}
+	}
+	// Smoothing reassigns isolated sites and rough interface sites to the majority type of their neighborhood
+	if (Ising_smoothing_threshold > 0) {
+		const vector<unsigned char> site_types_old = site_type_data;
+		int N_workers = min(N_threads, lattice.getLength());
+		vector<thread> workers;
+		for (int t = 1; t < N_workers; t++) {
+			workers.push_back(thread(&OSC_Sim::smoothIsingMorphology, this, cref(site_types_old), (t*lattice.getLength()) / N_workers, ((t + 1)*lattice.getLength()) / N_workers, cref(neighbor_offsets), cref(neighbor_weights)));
+		}
+		smoothIsingMorphology(site_types_old, 0, lattice.getLength() / N_workers, neighbor_offsets, neighbor_weights);
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+	N_donor_sites = (int)count(site_type_data.begin(), site_type_data.end(), (unsigned char)1);
+	N_acceptor_sites = (int)count(site_type_data.begin(), site_type_data.end(), (unsigned char)2);
 }
 
 void OSC_Sim::deleteObject(Object* object_ptr){
@@ -1586,6 +1980,11 @@ void OSC_Sim::deleteObject(Object* object_ptr){
         auto exciton_it = getExcitonIt(object_ptr);
         // Remove the object from Simulation
         removeObject(object_ptr);
+		updateFreeSites(object_ptr->getCoords(), false);
+		// Update transient data
+		if (Enable_dynamics_test) {
+			Transient_exciton_energy -= getSiteEnergy(object_ptr->getCoords());
+		}
         // Locate corresponding recombination event
         auto recombination_list_it = exciton_recombination_events.begin();
         std::advance(recombination_list_it,std::distance(excitons.begin(),exciton_it));
@@ -1604,25 +2003,30 @@ void OSC_Sim::deleteObject(Object* object_ptr){
 		// Locate corresponding exciton intersystem crossing event
 		auto intersystem_crossing_list_it = exciton_intersystem_crossing_events.begin();
 		std::advance(intersystem_crossing_list_it, std::distance(excitons.begin(), exciton_it));
-        // Delete exciton
-        excitons.erase(exciton_it);
-        // Delete exciton recombination event
-        exciton_recombination_events.erase(recombination_list_it);
-        // Delete exciton hop event
-        exciton_hop_events.erase(hop_list_it);
-        // Delete exciton dissociation event
-        exciton_dissociation_events.erase(dissociation_list_it);
-		// Delete exciton-exciton annihilation event
-		exciton_exciton_annihilation_events.erase(exciton_exciton_annihilation_list_it);
-		// Delete exciton-polaron annihilation event
-		exciton_polaron_annihilation_events.erase(exciton_polaron_annihilation_list_it);
-		// Delete exciton intersystem crossing event
-		exciton_intersystem_crossing_events.erase(intersystem_crossing_list_it);
+        // Return exciton to the pool
+        exciton_pool.splice(exciton_pool.end(), excitons, exciton_it);
+        // Return exciton recombination event to the pool
+        exciton_recombination_pool.splice(exciton_recombination_pool.end(), exciton_recombination_events, recombination_list_it);
+        // Return exciton hop event to the pool
+        exciton_hop_pool.splice(exciton_hop_pool.end(), exciton_hop_events, hop_list_it);
+        // Return exciton dissociation event to the pool
+        exciton_dissociation_pool.splice(exciton_dissociation_pool.end(), exciton_dissociation_events, dissociation_list_it);
+		// Return exciton-exciton annihilation event to the pool
+		exciton_exciton_annihilation_pool.splice(exciton_exciton_annihilation_pool.end(), exciton_exciton_annihilation_events, exciton_exciton_annihilation_list_it);
+		// Return exciton-polaron annihilation event to the pool
+		exciton_polaron_annihilation_pool.splice(exciton_polaron_annihilation_pool.end(), exciton_polaron_annihilation_events, exciton_polaron_annihilation_list_it);
+		// Return exciton intersystem crossing event to the pool
+		exciton_intersystem_crossing_pool.splice(exciton_intersystem_crossing_pool.end(), exciton_intersystem_crossing_events, intersystem_crossing_list_it);
     }
     else if(object_ptr->getObjectType().compare(Polaron::object_type)==0){
         auto polaron_it = getPolaronIt(object_ptr);
         // Remove the object from Simulation
         removeObject(object_ptr);
+		updateFreeSites(object_ptr->getCoords(), false);
+		// Update transient data
+		if (Enable_dynamics_test || Enable_ToF_test) {
+			(polaron_it->getCharge() ? Transient_hole_energy : Transient_electron_energy) -= getSiteEnergy(object_ptr->getCoords());
+		}
         // Electron
         if(!(polaron_it->getCharge())){
             // Locate corresponding recombination event
@@ -1634,14 +2038,14 @@ void OSC_Sim::deleteObject(Object* object_ptr){
             // Locate corresponding extractio event
             auto extraction_list_it = electron_extraction_events.begin();
 			std::advance(extraction_list_it,std::distance(electrons.begin(),polaron_it));
-            // Delete electron
-            electrons.erase(polaron_it);
-            // Delete polaron recombination event
-            polaron_recombination_events.erase(recombination_list_it);
-            // Delete electron hop event
-            electron_hop_events.erase(hop_list_it);
-            // Delete electron extraction event
-            electron_extraction_events.erase(extraction_list_it);
+            // Return electron to the pool
+            polaron_pool.splice(polaron_pool.end(), electrons, polaron_it);
+            // Return polaron recombination event to the pool
+            polaron_recombination_pool.splice(polaron_recombination_pool.end(), polaron_recombination_events, recombination_list_it);
+            // Return electron hop event to the pool
+            polaron_hop_pool.splice(polaron_hop_pool.end(), electron_hop_events, hop_list_it);
+            // Return electron extraction event to the pool
+            polaron_extraction_pool.splice(polaron_extraction_pool.end(), electron_extraction_events, extraction_list_it);
         }
         // Hole
         else{
@@ -1651,19 +2055,20 @@ void OSC_Sim::deleteObject(Object* object_ptr){
             // Locate corresponding extraction event
             auto extraction_list_it = hole_extraction_events.begin();
 			std::advance(extraction_list_it,std::distance(holes.begin(),polaron_it));
-            // Delete hole
-            holes.erase(polaron_it);
-            // Delete hole hop event
-            hole_hop_events.erase(hop_list_it);
-            // Delete hole extraction event
-            hole_extraction_events.erase(extraction_list_it);
+            // Return hole to the pool
+            polaron_pool.splice(polaron_pool.end(), holes, polaron_it);
+            // Return hole hop event to the pool
+            polaron_hop_pool.splice(polaron_hop_pool.end(), hole_hop_events, hop_list_it);
+            // Return hole extraction event to the pool
+            polaron_extraction_pool.splice(polaron_extraction_pool.end(), hole_extraction_events, extraction_list_it);
         }
     }
 }
 
 bool OSC_Sim::executeExcitonCreation(){
     // Create new exciton and determine its coordinates
-	Coords coords_new = generateExciton();
+	Coords coords_new = calculateExcitonCreationCoords();
+	generateExciton(coords_new);
 	// Update event list
 	auto recalc_objects = findRecalcObjects(coords_new, coords_new);
 	calculateObjectListEvents(recalc_objects);
@@ -1677,6 +2082,10 @@ bool OSC_Sim::executeExcitonDissociation(const list<Event*>::const_iterator even
     Coords coords_initial = (((*event_it)->getObjectPtr()))->getCoords();
     Coords coords_dest = (*event_it)->getDestCoords();
 	bool spin_state = (getExcitonIt((*event_it)->getObjectPtr()))->getSpin();
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent((*event_it)->getObjectPtr(), Trajectory_Recorder::Dissociation);
+	}
     // Delete exciton and its events
     deleteObject((*event_it)->getObjectPtr());
     // Generate new electron and hole
@@ -1718,6 +2127,10 @@ bool OSC_Sim::executeExcitonExcitonAnnihilation(const list<Event*>::const_iterat
 		// Target triplet exciton becomes a singlet exciton
 		getExcitonIt((*event_it)->getObjectTargetPtr())->flipSpin();
 	}
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent(object_ptr, Trajectory_Recorder::Annihilation);
+	}
 	// delete exciton and its events
 	deleteObject((*event_it)->getObjectPtr());
 	// Update exciton counters
@@ -1756,6 +2169,10 @@ bool OSC_Sim::executeExcitonPolaronAnnihilation(const list<Event*>::const_iterat
 	bool spin_state = (getExcitonIt((*event_it)->getObjectPtr()))->getSpin();
 	Coords coords_initial = object_ptr->getCoords();
 	Coords coords_dest = (*event_it)->getDestCoords();
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent(object_ptr, Trajectory_Recorder::Annihilation);
+	}
 	// delete exciton and its events
 	deleteObject((*event_it)->getObjectPtr());
 	// Update exciton counters
@@ -1802,6 +2219,10 @@ bool OSC_Sim::executeExcitonIntersystemCrossing(const list<Event*>::const_iterat
 	bool spin_i = exciton_it->getSpin();
 	// Execute spin flip
 	exciton_it->flipSpin();
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent((*event_it)->getObjectPtr(), Trajectory_Recorder::Intersystem_crossing);
+	}
 	// Update exciton counters
 	if (spin_i) {
 		N_exciton_intersystem_crossings++;
@@ -1835,7 +2256,11 @@ bool OSC_Sim::executeExcitonRecombination(const list<Event*>::const_iterator eve
 	bool spin_state = (getExcitonIt((*event_it)->getObjectPtr()))->getSpin();
 	// Output diffusion distance
 	if (Enable_exciton_diffusion_test) {
-		diffusion_distances.push_back(((*event_it)->getObjectPtr())->calculateDisplacement());
+		diffusion_stats.addValue(((*event_it)->getObjectPtr())->calculateDisplacement());
+	}
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent((*event_it)->getObjectPtr(), Trajectory_Recorder::Recombination);
 	}
 	// delete exciton and its events
 	deleteObject((*event_it)->getObjectPtr());
@@ -1868,28 +2293,12 @@ bool OSC_Sim::executeNextEvent() {
 	}
 	// Perform Transients test analysis
 	if (Enable_dynamics_test || Enable_ToF_test) {
-		updateTransientData();
-		// If none of the excitons or polarons can move or the cycle has reached the transient cutoff
-		if (getN_events() == 0 || (getTime() - Transient_creation_time) > Transient_end) {
+		// If none of the excitons or polarons can move or the cycle has passed the end of the last time bin
+		if (getN_events() == 0 || (getTime() - Transient_creation_time) > transient_bins.getEdge(transient_bins.getN_bins())) {
+			// Any remaining objects are frozen, so their contributions are integrated to the end of the last time bin
+			integrateTransientData(Transient_creation_time + transient_bins.getEdge(transient_bins.getN_bins()));
 			// Remove any remaining excitons and polarons
-			while ((int)excitons.size() > 0) {
-				if (excitons.front().getSpin()) {
-					N_singlets--;
-				}
-				else {
-					N_triplets--;
-				}
-				N_excitons--;
-				deleteObject(&excitons.front());
-			}
-			while ((int)electrons.size() > 0) {
-				N_electrons--;
-				deleteObject(&electrons.front());
-			}
-			while ((int)holes.size() > 0) {
-				N_holes--;
-				deleteObject(&holes.front());
-			}
+			resetTransientCycle();
 		}
 		// Check if new excitons or polarons need to be created
 		if (N_excitons==0 && N_holes == 0 && N_electrons == 0 && !checkFinished()) {
@@ -1915,6 +2324,10 @@ bool OSC_Sim::executeNextEvent() {
     if(isLoggingEnabled()){
         *Logfile << "Executing " << event_type << " event" << endl;
     }
+	// Integrate the transient data over the time interval before the event is executed
+	if (Enable_dynamics_test || Enable_ToF_test) {
+		integrateTransientData((*event_it)->getExecutionTime());
+	}
     // Update simulation time
     setTime((*event_it)->getExecutionTime());
     // Execute the chosen event
@@ -1962,8 +2375,19 @@ bool OSC_Sim::executeObjectHop(const list<Event*>::const_iterator event_it) {
 	auto object_ptr = (*event_it)->getObjectPtr();
 	Coords coords_initial = object_ptr->getCoords();
 	Coords coords_dest = (*event_it)->getDestCoords();
+	double displacement_initial = object_ptr->calculateDisplacement();
 	// Move the object in the Simulation
 	moveObject((*event_it)->getObjectPtr(), coords_dest);
+	updateFreeSites(coords_initial, false);
+	updateFreeSites(coords_dest, true);
+	// Update transient data
+	if (Enable_dynamics_test || Enable_ToF_test) {
+		updateTransientHop(object_ptr, coords_initial, displacement_initial);
+	}
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent(object_ptr, Trajectory_Recorder::Hop);
+	}
 	// Update event list
 	auto recalc_objects = findRecalcObjects(coords_initial, coords_dest);
 	calculateObjectListEvents(recalc_objects);
@@ -1978,7 +2402,9 @@ bool OSC_Sim::executePolaronExtraction(const list<Event*>::const_iterator event_
     Coords coords_initial = ((*event_it)->getObjectPtr())->getCoords();
     // Save transit time and extraction location info
     if(Enable_ToF_test){
-        transit_times.push_back(getTime()-((*event_it)->getObjectPtr())->getCreationTime());
+        double transit_time = getTime()-((*event_it)->getObjectPtr())->getCreationTime();
+        transit_time_stats.addValue(transit_time);
+        mobility_stats.addValue(intpow(1e-7*lattice.getUnitSize()*lattice.getHeight(), 2) / (fabs(Internal_potential)*transit_time));
     }
 	if (Enable_ToF_test || Enable_IQE_test) {
 		if (!charge) {
@@ -1988,6 +2414,10 @@ bool OSC_Sim::executePolaronExtraction(const list<Event*>::const_iterator event_
 			hole_extraction_data[lattice.getWidth()*coords_initial.x + coords_initial.y]++;
 		}
 	}
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent((*event_it)->getObjectPtr(), Trajectory_Recorder::Extraction);
+	}
     // Delete polaron and its events
     deleteObject((*event_it)->getObjectPtr());
     // Update polaron counters
@@ -2043,6 +2473,11 @@ bool OSC_Sim::executePolaronRecombination(const list<Event*>::const_iterator eve
     int target_tag = ((*event_it)->getObjectTargetPtr())->getTag();
     Coords coords_initial = object_ptr->getCoords();
     Coords coords_dest = (*event_it)->getDestCoords();
+	// Record trajectory events
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent(object_ptr, Trajectory_Recorder::Recombination);
+		recordTrajectoryEvent((*event_it)->getObjectTargetPtr(), Trajectory_Recorder::Recombination);
+	}
     // Delete polarons and their events
     deleteObject((*event_it)->getObjectTargetPtr());
     deleteObject(object_ptr);
@@ -2067,31 +2502,30 @@ bool OSC_Sim::executePolaronRecombination(const list<Event*>::const_iterator eve
     return true;
 }
 
-Coords OSC_Sim::generateExciton(){
-	// Determine coords
-	Coords coords = calculateExcitonCreationCoords();
+void OSC_Sim::generateExciton(const Coords& coords){
     // Create the new exciton and add it to the simulation
     Exciton exciton_new(getTime(),N_excitons_created+1,coords);
 	exciton_new.setSpin(true); // Generated exciton is in singlet state
-    excitons.push_back(exciton_new);
+    pushBackRecycled(excitons, exciton_pool, exciton_new);
 	Object* object_ptr = &excitons.back();
     addObject(object_ptr);
+	updateFreeSites(coords, true);
     // Add placeholder events to the corresponding lists
 	Simulation* sim_ptr = this;
     Exciton_Hop hop_event(sim_ptr);
-    exciton_hop_events.push_back(hop_event);
+    pushBackRecycled(exciton_hop_events, exciton_hop_pool, hop_event);
     Exciton_Recombination recombination_event(sim_ptr);
     recombination_event.setObjectPtr(object_ptr);
-    exciton_recombination_events.push_back(recombination_event);
+    pushBackRecycled(exciton_recombination_events, exciton_recombination_pool, recombination_event);
     Exciton_Dissociation dissociation_event(sim_ptr);
-    exciton_dissociation_events.push_back(dissociation_event);
+    pushBackRecycled(exciton_dissociation_events, exciton_dissociation_pool, dissociation_event);
 	Exciton_Exciton_Annihilation exciton_exciton_annihilation_event(sim_ptr);
-	exciton_exciton_annihilation_events.push_back(exciton_exciton_annihilation_event);
+	pushBackRecycled(exciton_exciton_annihilation_events, exciton_exciton_annihilation_pool, exciton_exciton_annihilation_event);
 	Exciton_Polaron_Annihilation exciton_polaron_annihilation_event(sim_ptr);
-	exciton_polaron_annihilation_events.push_back(exciton_polaron_annihilation_event);
+	pushBackRecycled(exciton_polaron_annihilation_events, exciton_polaron_annihilation_pool, exciton_polaron_annihilation_event);
 	Exciton_Intersystem_Crossing intersystem_crossing_event(sim_ptr);
 	intersystem_crossing_event.setObjectPtr(object_ptr);
-	exciton_intersystem_crossing_events.push_back(intersystem_crossing_event);
+	pushBackRecycled(exciton_intersystem_crossing_events, exciton_intersystem_crossing_pool, intersystem_crossing_event);
     // Update exciton counters
     if(getSiteType(coords)==(short)1){
         N_excitons_created_donor++;
@@ -2102,11 +2536,18 @@ Coords OSC_Sim::generateExciton(){
     N_excitons_created++;
     N_excitons++;
 	N_singlets++;
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent(object_ptr, Trajectory_Recorder::Creation);
+	}
+	// Update transient data
+	if (Enable_dynamics_test) {
+		Transient_exciton_energy += getSiteEnergy(coords);
+	}
     // Log event
     if(isLoggingEnabled()){
         *Logfile << "Created exciton " << exciton_new.getTag() << " at site " << coords.x << "," << coords.y << "," << coords.z << "." << endl;
     }
-	return coords;
 }
 
 void OSC_Sim::generateElectron(const Coords& coords,int tag=0){
@@ -2115,29 +2556,33 @@ void OSC_Sim::generateElectron(const Coords& coords,int tag=0){
     }
     // Create the new electron and add it to the simulation
     Polaron electron_new(getTime(),tag,coords,false);
-    electrons.push_back(electron_new);
+    pushBackRecycled(electrons, polaron_pool, electron_new);
 	Object* object_ptr = &electrons.back();
     addObject(object_ptr);
+	updateFreeSites(coords, true);
     // Add placeholder events to the corresponding lists
 	Simulation* sim_ptr = this;
     Polaron_Hop hop_event(sim_ptr);
-    electron_hop_events.push_back(hop_event);
+    pushBackRecycled(electron_hop_events, polaron_hop_pool, hop_event);
     Polaron_Recombination recombination_event(sim_ptr);
-    polaron_recombination_events.push_back(recombination_event);
+    pushBackRecycled(polaron_recombination_events, polaron_recombination_pool, recombination_event);
     Polaron_Extraction extraction_event(sim_ptr);
     extraction_event.setObjectPtr(object_ptr);
-    electron_extraction_events.push_back(extraction_event);
+    pushBackRecycled(electron_extraction_events, polaron_extraction_pool, extraction_event);
     // Update exciton counters
     N_electrons_created++;
     N_electrons++;
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent(object_ptr, Trajectory_Recorder::Creation);
+	}
     // Log event
     if(isLoggingEnabled()){
         *Logfile << "Created electron " << electron_new.getTag() << " at site " << coords.x << "," << coords.y << "," << coords.z << "." << endl;
     }
 	// Update transient data
-	if (Enable_dynamics_test) {
-		transient_electron_tags.push_back(electrons.back().getTag());
-		transient_electron_energies_prev.push_back(0);
+	if (Enable_dynamics_test || Enable_ToF_test) {
+		Transient_electron_energy += getSiteEnergy(coords);
 	}
 }
 
@@ -2147,27 +2592,31 @@ void OSC_Sim::generateHole(const Coords& coords,int tag=0){
     }
     // Create the new hole and add it to the simulation
     Polaron hole_new(getTime(),tag,coords,true);
-    holes.push_back(hole_new);
+    pushBackRecycled(holes, polaron_pool, hole_new);
 	Object* object_ptr = &holes.back();
     addObject(object_ptr);
+	updateFreeSites(coords, true);
     // Add placeholder events to the corresponding lists
 	Simulation* sim_ptr = this;
     Polaron_Hop hop_event(sim_ptr);
-    hole_hop_events.push_back(hop_event);
+    pushBackRecycled(hole_hop_events, polaron_hop_pool, hop_event);
     Polaron_Extraction extraction_event(sim_ptr);
     extraction_event.setObjectPtr(object_ptr);
-    hole_extraction_events.push_back(extraction_event);
+    pushBackRecycled(hole_extraction_events, polaron_extraction_pool, extraction_event);
     // Update exciton counters
     N_holes_created++;
     N_holes++;
+	// Record trajectory event
+	if (Enable_trajectory_recording) {
+		recordTrajectoryEvent(object_ptr, Trajectory_Recorder::Creation);
+	}
     // Log event
     if(isLoggingEnabled()){
         *Logfile << "Created hole " << hole_new.getTag() << " at site " << coords.x << "," << coords.y << "," << coords.z << "." << endl;
     }
 	// Update transient data
-	if (Enable_dynamics_test) {
-		transient_hole_tags.push_back(holes.back().getTag());
-		transient_hole_energies_prev.push_back(0);
+	if (Enable_dynamics_test || Enable_ToF_test) {
+		Transient_hole_energy += getSiteEnergy(coords);
 	}
 }
 
@@ -2176,29 +2625,29 @@ void OSC_Sim::generateDynamicsExcitons(){
 	if (N_excitons_created > 0) {
 		reassignSiteEnergies();
 	}
-	// Initialize transient data vectors
 	static const int N_initial_excitons = (int)ceil(Dynamics_initial_exciton_conc*lattice.getVolume());
-	transient_exciton_tags.assign(N_initial_excitons, -1);
-	transient_exciton_energies_prev.assign(N_initial_excitons, 0);
-	transient_electron_tags.clear();
-	transient_electron_energies_prev.clear();
-	transient_hole_tags.clear();
-	transient_hole_energies_prev.clear();
 	N_transient_cycles++;
-    int num = 0;
     cout << getId() << ": Dynamics transient cycle " << N_transient_cycles << ": Generating " << N_initial_excitons << " initial excitons." << endl;
-    while(num<N_initial_excitons){
-        generateExciton();
-		transient_exciton_tags[num] = excitons.back().getTag();
-		transient_exciton_energies_prev[num] = getSiteEnergy(excitons.back().getCoords());
-        num++;
-    }
+	// The number of initial excitons on each site type is drawn according to the generation rates, and the sites of each type are then
+	// sampled without replacement from the free site lists in a single pass
+	binomial_distribution<int> dist_donor(N_initial_excitons, R_exciton_generation_donor / (R_exciton_generation_donor + R_exciton_generation_acceptor));
+	const int N_donor_excitons = dist_donor(generator);
+	const int N_type_excitons[3] = { 0, N_donor_excitons, N_initial_excitons - N_donor_excitons };
+	for (short type = 1; type <= 2; type++) {
+		if (N_type_excitons[type] > free_sites.getNumSites(type)) {
+			cout << getId() << ": Error! There are not enough empty sites to create the initial excitons." << endl;
+			setErrorMessage("There are not enough empty sites to create the initial excitons.");
+			Error_found = true;
+			return;
+		}
+		for (auto site_index : free_sites.chooseRandomSites(type, N_type_excitons[type], generator)) {
+			Coords coords = lattice.getSiteCoords(site_index);
+			generateExciton(coords);
+		}
+	}
 	Transient_creation_time = getTime();
-	Transient_index_prev = -1;
-	Transient_singlet_counts_prev = N_singlets;
-	Transient_triplet_counts_prev = N_triplets;
-	Transient_electron_counts_prev = N_electrons;
-	Transient_hole_counts_prev = N_holes;
+	Transient_index = -1;
+	Transient_time_prev = 0;
     auto object_its = getAllObjectPtrs();
     calculateObjectListEvents(object_its);
 }
@@ -2217,56 +2666,34 @@ void OSC_Sim::generateToFPolarons(){
     else{
         coords.z = 0;
     }
-	// Initialize transient data vectors
-	if (!ToF_polaron_type) {
-		transient_electron_tags.assign(ToF_initial_polarons, -1);
-		transient_electron_energies_prev.assign(ToF_initial_polarons, 0);
-		Transient_electron_counts_prev = ToF_initial_polarons;
-	}
-	else {
-		transient_hole_tags.assign(ToF_initial_polarons, -1);
-		transient_hole_energies_prev.assign(ToF_initial_polarons, 0);
-		Transient_hole_counts_prev = ToF_initial_polarons;
-	}
-    ToF_positions_prev.assign(ToF_initial_polarons,coords.z);
 	Transient_creation_time = getTime();
-	Transient_index_prev = -1;
+	Transient_index = -1;
+	Transient_time_prev = 0;
 	N_transient_cycles++;
 	cout << getId() << ": ToF transient cycle " << N_transient_cycles << ": Generating " << ToF_initial_polarons << " initial polarons." << endl;
-	int num = 0;
-    while(num<ToF_initial_polarons){
-        coords.x = lattice.generateRandomX();
-        coords.y = lattice.generateRandomY();
-        // If the site is already occupied, pick a new site
-        if(lattice.isOccupied(coords)){
-            continue;
-        }
-        // If phase restriction is enabled, electrons cannot be created on donor sites
-        else if(Enable_phase_restriction && !ToF_polaron_type && getSiteType(coords)==(short)1){
-            continue;
-        }
-        // If phase restriction is enabled, holes cannot be created on acceptor sites
-        else if(Enable_phase_restriction && ToF_polaron_type && getSiteType(coords)==(short)2){
-            continue;
-        }
-        else if(!ToF_polaron_type){
+	// Polarons are created on distinct unoccupied sites of the injection plane sampled from the free injection site list in a single pass
+	if (ToF_initial_polarons > free_injection_sites.getNumSites(0)) {
+		cout << getId() << ": Error! There are not enough empty sites to create the initial time-of-flight polarons." << endl;
+		setErrorMessage("There are not enough empty sites to create the initial time-of-flight polarons.");
+		Error_found = true;
+		return;
+	}
+	for (auto plane_index : free_injection_sites.chooseRandomSites(0, ToF_initial_polarons, generator)) {
+		coords.x = plane_index / lattice.getWidth();
+		coords.y = plane_index % lattice.getWidth();
+        if(!ToF_polaron_type){
             generateElectron(coords);
-			transient_electron_tags[num] = electrons.back().getTag();
-			transient_electron_energies_prev[num] = getSiteEnergy(coords);
         }
         else{
             generateHole(coords);
-			transient_hole_tags[num] = holes.back().getTag();
-			transient_hole_energies_prev[num] = getSiteEnergy(coords);
         }
-        num++;
     }
     auto object_its = getAllObjectPtrs();
     calculateObjectListEvents(object_its);
 }
 
-vector<double> OSC_Sim::getDiffusionData() const {
-    return diffusion_distances;
+Sample_Statistics OSC_Sim::getDiffusionStats() const {
+    return diffusion_stats;
 }
 
 vector<double> OSC_Sim::getDynamicsExcitonMSDV() const {
@@ -2293,23 +2720,29 @@ vector<double> OSC_Sim::getDynamicsHoleEnergies() const {
 	return transient_hole_energies;
 }
 
-vector<int> OSC_Sim::getDynamicsTransientSinglets() const {
+vector<double> OSC_Sim::getDynamicsTransientSinglets() const {
     return transient_singlet_counts;
 }
 
-vector<int> OSC_Sim::getDynamicsTransientTriplets() const {
+vector<double> OSC_Sim::getDynamicsTransientTriplets() const {
 	return transient_triplet_counts;
 }
 
-vector<int> OSC_Sim::getDynamicsTransientElectrons() const {
+vector<double> OSC_Sim::getDynamicsTransientElectrons() const {
     return transient_electron_counts;
 }
 
-vector<pair<double, double>> OSC_Sim::getDOSCorrelationData() const {
+vector<pair<double, double>> OSC_Sim::getDOSCorrelationData() {
+	if (Enable_correlated_disorder && !isDOSCorrelationCurrent) {
+		double distance_max, scale_factor;
+		calculateCorrelationKernelParams(Disorder_correlation_length, distance_max, scale_factor);
+		DOS_correlation_data = calculateDOSCorrelation(distance_max);
+		isDOSCorrelationCurrent = true;
+	}
 	return DOS_correlation_data;
 }
 
-vector<int> OSC_Sim::getDynamicsTransientHoles() const {
+vector<double> OSC_Sim::getDynamicsTransientHoles() const {
     return transient_hole_counts;
 }
 
@@ -2329,10 +2762,18 @@ list<Exciton>::iterator OSC_Sim::getExcitonIt(const Object* object_ptr){
 	return excitons.end();
 }
 
+double OSC_Sim::getInterfacialArea() const {
+	return N_interface_pairs*intpow(lattice.getUnitSize(), 2);
+}
+
 double OSC_Sim::getInternalField() const {
 	return Internal_potential / (1e-7*lattice.getHeight()*lattice.getUnitSize());
 }
 
+Sample_Statistics OSC_Sim::getMobilityStats() const {
+	return mobility_stats;
+}
+
 int OSC_Sim::getN_bimolecular_recombinations() const {
     return N_bimolecular_recombinations;
 }
@@ -2349,6 +2790,26 @@ int OSC_Sim::getN_electrons_recombined() const {
     return N_electrons_recombined;
 }
 
+int OSC_Sim::getN_interface_sites(const short site_type) const {
+	if (site_type == (short)1) {
+		return N_donor_interface_sites;
+	}
+	else if (site_type == (short)2) {
+		return N_acceptor_interface_sites;
+	}
+	return 0;
+}
+
+int OSC_Sim::getN_sites(const short site_type) const {
+	if (site_type == (short)1) {
+		return N_donor_sites;
+	}
+	else if (site_type == (short)2) {
+		return N_acceptor_sites;
+	}
+	return 0;
+}
+
 int OSC_Sim::getN_excitons_created() const {
     return N_excitons_created;
 }
@@ -2439,22 +2900,39 @@ list<Polaron>::iterator OSC_Sim::getPolaronIt(const Object* object_ptr) {
 	return electrons.end();
 }
 
+double OSC_Sim::getEffectiveSiteEnergy(const bool charge, const long int site_index) const {
+	if (!Enable_procedural_dos) {
+		return (!charge) ? E_effective_electron[site_index] : E_effective_hole[site_index];
+	}
+	// Procedural site energies are combined with the internal potential and the HOMO/LUMO levels on demand, using the same convention as updateEffectiveSiteEnergies
+	const double E_site = calculateProceduralSiteEnergy(site_index);
+	const int z = (int)(site_index % lattice.getHeight());
+	const bool isDonor = (getSiteType(site_index) == (short)1);
+	if (!charge) {
+		return E_site + E_potential[z] - (isDonor ? Lumo_donor : Lumo_acceptor);
+	}
+	return E_site - E_potential[z] - (isDonor ? Homo_donor : Homo_acceptor);
+}
+
 vector<double> OSC_Sim::getSiteEnergies(const short site_type) const {
 	vector<double> energies;
 	for(int i = 0; i < lattice.getNumSites(); i++) {
-		if (sites[i].getType() == site_type) {
-			energies.push_back(sites[i].getEnergy());
+		if (getSiteType(i) == site_type) {
+			energies.push_back(Enable_procedural_dos ? calculateProceduralSiteEnergy(i) : sites[i].getEnergy());
 		}
 	}
 	return energies;
 }
 
 double OSC_Sim::getSiteEnergy(const Coords& coords) const {
+	if (Enable_procedural_dos) {
+		return calculateProceduralSiteEnergy(lattice.getSiteIndex(coords));
+	}
 	return sites[lattice.getSiteIndex(coords)].getEnergy();
 }
 
 short OSC_Sim::getSiteType(const Coords& coords) const {
-	return sites[lattice.getSiteIndex(coords)].getType();
+	return getSiteType(lattice.getSiteIndex(coords));
 }
 
 vector<string> OSC_Sim::getChargeExtractionMap(const bool charge) const {
@@ -2493,7 +2971,7 @@ vector<string> OSC_Sim::getChargeExtractionMap(const bool charge) const {
 	return output_data;
 }
 
-vector<int> OSC_Sim::getToFTransientCounts() const {
+vector<double> OSC_Sim::getToFTransientCounts() const {
 	if (!ToF_polaron_type) {
 		return transient_electron_counts;
 	}
@@ -2519,20 +2997,47 @@ vector<double> OSC_Sim::getToFTransientVelocities() const {
     return transient_velocities;
 }
 
-vector<double> OSC_Sim::getTransitTimeData() const {
-	return transit_times;
+Sample_Statistics OSC_Sim::getTransitTimeStats() const {
+	return transit_time_stats;
+}
+
+double OSC_Sim::hashToUniform(const unsigned long long seed, const unsigned long long counter) {
+	// SplitMix64 finalizer applied to the counter and then to the seeded result, giving a uniform number in the open interval (0,1)
+	unsigned long long z = counter + 0x9E3779B97F4A7C15ULL;
+	for (int round = 0; round < 2; round++) {
+		z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+		z = z ^ (z >> 31);
+		if (round == 0) {
+			z += seed*0x9E3779B97F4A7C15ULL + 0x632BE59BD9B4E019ULL;
+		}
+	}
+	return ((double)(z >> 11) + 0.5)*(1.0 / 9007199254740992.0);
 }
 
 bool OSC_Sim::initializeArchitecture() {
 	bool success;
 	N_donor_sites = 0;
 	N_acceptor_sites = 0;
-	if (Enable_neat) {
+	if (Previous_sim != nullptr) {
+		// The site types of a previous simulation on the same lattice are copied, or are shared again when they are in shared memory
+		if (Previous_sim->sites.size() != sites.size()) {
+			cout << getId() << ": Error! The lattice of the previous simulation does not match the lattice defined by the parameters." << endl;
+			setErrorMessage("The lattice of the previous simulation does not match the lattice defined by the parameters.");
+			Error_found = true;
+			return false;
+		}
+		if (site_types != Shared_site_types) {
+			site_type_data = Previous_sim->site_type_data;
+			site_types = site_type_data.data();
+		}
+		N_donor_sites = Previous_sim->N_donor_sites;
+		N_acceptor_sites = Previous_sim->N_acceptor_sites;
+	}
+	else if (Enable_neat) {
 		N_donor_sites = lattice.getNumSites();
 		N_acceptor_sites = 0;
-		for (auto &item : sites) {
-			item.setType(1);
-		}
+		fill(site_type_data.begin(), site_type_data.end(), (unsigned char)1);
 	}
 	else if (Enable_bilayer) {
 		Coords coords;
@@ -2541,11 +3046,11 @@ bool OSC_Sim::initializeArchitecture() {
 				for (int z = 0; z < lattice.getHeight(); z++) {
 					coords.setXYZ(x, y, z);
 					if (z < Thickness_acceptor) {
-						sites[lattice.getSiteIndex(coords)].setType(2);
+						setSiteType(lattice.getSiteIndex(coords), 2);
 						N_acceptor_sites++;
 					}
 					else {
-						sites[lattice.getSiteIndex(coords)].setType(1);
+						setSiteType(lattice.getSiteIndex(coords), 1);
 						N_donor_sites++;
 					}
 				}
@@ -2553,17 +3058,16 @@ bool OSC_Sim::initializeArchitecture() {
 		}
 	}
 	else if (Enable_random_blend) {
-		vector<short> site_types;
-		site_types.assign(lattice.getNumSites(), 1);
+		site_type_data.assign(lattice.getNumSites(), 1);
 		for (int i = 0; i < (int)lattice.getNumSites()*Acceptor_conc; i++) {
-			site_types[i] = 2;
+			site_type_data[i] = 2;
 			N_acceptor_sites++;
 		}
 		N_donor_sites = lattice.getNumSites() - N_acceptor_sites;
-		shuffle(site_types.begin(), site_types.end(), generator);
-		for (int i = 0; i < sites.size(); i++) {
-			sites[i].setType(site_types[i]);
-		}
+		shuffle(site_type_data.begin(), site_type_data.end(), generator);
+	}
+	else if (Enable_ising_blend) {
+		createIsingMorphology();
 	}
 	else if (Enable_import_morphology) {
 		success = createImportedMorphology();
@@ -2580,6 +3084,71 @@ bool OSC_Sim::initializeArchitecture() {
 	return true;
 }
 
+void OSC_Sim::initializeFreeSites() {
+	free_sites.init(3, lattice.getNumSites());
+	for (int n = 0; n < lattice.getNumSites(); n++) {
+		free_sites.addSite(getSiteType(n), n);
+	}
+	free_injection_sites.init(1, lattice.getLength()*lattice.getWidth());
+	if (Enable_ToF_test) {
+		Coords coords;
+		coords.z = ToF_polaron_type ? 0 : lattice.getHeight() - 1;
+		for (coords.x = 0; coords.x < lattice.getLength(); coords.x++) {
+			for (coords.y = 0; coords.y < lattice.getWidth(); coords.y++) {
+				if (isToFInjectionSite(coords)) {
+					free_injection_sites.addSite(0, coords.x*lattice.getWidth() + coords.y);
+				}
+			}
+		}
+	}
+}
+
+void OSC_Sim::integrateTransientData(const double time) {
+	// The populations and total energies only change when events are executed, so the interval since the previous update is split across
+	// the time bins that it spans and each bin accumulates the time-weighted average over its width
+	const double time_elapsed = time - Transient_creation_time;
+	while (Transient_index < (int)transient_times.size() && Transient_time_prev < time_elapsed) {
+		double time_next = min(time_elapsed, transient_bins.getEdge(Transient_index + 1));
+		if (Transient_index >= 0) {
+			double weight = (time_next - Transient_time_prev) / (transient_bins.getEdge(Transient_index + 1) - transient_bins.getEdge(Transient_index));
+			if (Enable_dynamics_test) {
+				transient_singlet_counts[Transient_index] += weight*N_singlets;
+				transient_triplet_counts[Transient_index] += weight*N_triplets;
+				transient_electron_counts[Transient_index] += weight*N_electrons;
+				transient_hole_counts[Transient_index] += weight*N_holes;
+				transient_exciton_energies[Transient_index] += weight*Transient_exciton_energy;
+				transient_electron_energies[Transient_index] += weight*Transient_electron_energy;
+				transient_hole_energies[Transient_index] += weight*Transient_hole_energy;
+			}
+			else if (!ToF_polaron_type) {
+				transient_electron_counts[Transient_index] += weight*N_electrons;
+				transient_electron_energies[Transient_index] += weight*Transient_electron_energy;
+			}
+			else {
+				transient_hole_counts[Transient_index] += weight*N_holes;
+				transient_hole_energies[Transient_index] += weight*Transient_hole_energy;
+			}
+		}
+		Transient_time_prev = time_next;
+		// Move on to the next bin once the current one has been completed
+		if (time_next == transient_bins.getEdge(Transient_index + 1)) {
+			Transient_index++;
+		}
+	}
+}
+
+bool OSC_Sim::isToFInjectionSite(const Coords& coords) const {
+	// Electrons are created at the top plane of the lattice and holes are created at the bottom plane
+	if (coords.z != (ToF_polaron_type ? 0 : lattice.getHeight() - 1)) {
+		return false;
+	}
+	// If phase restriction is enabled, electrons cannot be created on donor sites and holes cannot be created on acceptor sites
+	if (Enable_phase_restriction && getSiteType(coords) == (ToF_polaron_type ? (short)2 : (short)1)) {
+		return false;
+	}
+	return true;
+}
+
 void OSC_Sim::outputStatus(){
     cout << getId() << ": Time = " << getTime() << " seconds.\n";
     if(Enable_ToF_test){
@@ -2623,59 +3192,124 @@ void OSC_Sim::outputStatus(){
     cout.flush();
 }
 
-void OSC_Sim::reassignSiteEnergies() {
+void OSC_Sim::createSiteEnergies(vector<double>& energies_donor, vector<double>& energies_acceptor, mt19937& gen) {
 	if (Enable_gaussian_dos) {
-		site_energies_donor.assign(N_donor_sites, 0);
-		site_energies_acceptor.assign(N_acceptor_sites, 0);
-		createGaussianDOSVector(site_energies_donor, 0, Energy_stdev_donor, generator);
-		createGaussianDOSVector(site_energies_acceptor, 0, Energy_stdev_acceptor, generator);
+		energies_donor.assign(N_donor_sites, 0);
+		energies_acceptor.assign(N_acceptor_sites, 0);
+		createGaussianDOSVector(energies_donor, 0, Energy_stdev_donor, gen);
+		createGaussianDOSVector(energies_acceptor, 0, Energy_stdev_acceptor, gen);
 	}
 	else if (Enable_exponential_dos) {
-		site_energies_donor.assign(N_donor_sites, 0);
-		site_energies_acceptor.assign(N_acceptor_sites, 0);
-		createExponentialDOSVector(site_energies_donor, 0, Energy_urbach_donor, generator);
-		createExponentialDOSVector(site_energies_acceptor, 0, Energy_urbach_acceptor, generator);
+		energies_donor.assign(N_donor_sites, 0);
+		energies_acceptor.assign(N_acceptor_sites, 0);
+		createExponentialDOSVector(energies_donor, 0, Energy_urbach_donor, gen);
+		createExponentialDOSVector(energies_acceptor, 0, Energy_urbach_acceptor, gen);
 	}
 	else {
-		site_energies_donor.push_back(0);
-		site_energies_acceptor.push_back(0);
-	}
-	int donor_count = 0;
-	int acceptor_count = 0;
-	for (int i = 0; i < lattice.getNumSites(); i++) {
-		if (Enable_gaussian_dos || Enable_exponential_dos) {
-			if (sites[i].getType() == (short)1) {
-				sites[i].setEnergyIt(site_energies_donor.begin() + donor_count);
-				donor_count++;
-			}
-			else if (sites[i].getType() == (short)2) {
-				sites[i].setEnergyIt(site_energies_acceptor.begin() + acceptor_count);
-				acceptor_count++;
-			}
-			else {
-				cout << getId() << ": Error! Undefined site type detected while assigning site energies." << endl;
-				setErrorMessage("Undefined site type detected while assigning site energies.");
-				Error_found = true;
-			}
-		}
-		else {
-			if (sites[i].getType() == (short)1) {
-				sites[i].setEnergyIt(site_energies_donor.begin());
-			}
-			else if (sites[i].getType() == (short)2) {
-				sites[i].setEnergyIt(site_energies_acceptor.begin());
-			}
-			else {
-				cout << getId() << ": Error! Undefined site type detected while assigning site energies." << endl;
-				setErrorMessage("Undefined site type detected while assigning site energies.");
-				Error_found = true;
-			}
-		}
+		energies_donor.assign(1, 0);
+		energies_acceptor.assign(1, 0);
 	}
 	if (Enable_correlated_disorder) {
-		createCorrelatedDOS(Disorder_correlation_length);
+		createCorrelatedDOS(Disorder_correlation_length, energies_donor, energies_acceptor);
 	}
-	//outputVectorToFile(site_energies_donor, "DOS_data.txt");
+}
+
+pair<vector<double>, vector<double>> OSC_Sim::createSiteEnergiesNext() {
+	pair<vector<double>, vector<double>> energies;
+	createSiteEnergies(energies.first, energies.second, generator_landscape);
+	return energies;
+}
+
+void OSC_Sim::reassignSiteEnergies() {
+	// Procedural site energies are not stored, so a new landscape only requires a new seed
+	if (Enable_procedural_dos) {
+		Landscape_seed = ((unsigned long long)generator() << 32) | (unsigned long long)generator();
+	}
+	// The initial energy landscape is created directly and subsequent landscapes are taken from the background buffer
+	else if (site_energies_next.valid()) {
+		auto energies = site_energies_next.get();
+		site_energies_donor.swap(energies.first);
+		site_energies_acceptor.swap(energies.second);
+	}
+	else {
+		createSiteEnergies(site_energies_donor, site_energies_acceptor, generator);
+	}
+	assignSiteEnergies();
+}
+
+void OSC_Sim::recordTrajectoryEvent(const Object* object_ptr, const unsigned char event_type) {
+	uint8_t species;
+	if (object_ptr->getObjectType().compare(Exciton::object_type) == 0) {
+		species = static_cast<const Exciton*>(object_ptr)->getSpin() ? Trajectory_Recorder::Singlet : Trajectory_Recorder::Triplet;
+	}
+	else {
+		species = static_cast<const Polaron*>(object_ptr)->getCharge() ? Trajectory_Recorder::Hole : Trajectory_Recorder::Electron;
+	}
+	if (!(Trajectory_species_mask & (1 << species))) {
+		return;
+	}
+	// Sampling is decided by the tag alone, so every event of a sampled object is recorded and the trajectory is complete
+	// The sampling hash is seeded with the processor id and does not consume random numbers from the simulation generator
+	const int tag = object_ptr->getTag();
+	if (tag % Trajectory_sampling_stride != 0) {
+		return;
+	}
+	if (Trajectory_sampling_probability < 1 && !(hashToUniform((unsigned long long)getId(), (unsigned long long)tag) < Trajectory_sampling_probability)) {
+		return;
+	}
+	const Coords& coords = object_ptr->getCoords();
+	Trajectory_recorder->addRecord(getTime(), tag, species, lattice.getSiteIndex(coords), event_type, getSiteEnergy(coords));
+}
+
+void OSC_Sim::resetTransientCycle() {
+	// Record the end of the trajectories of the remaining objects
+	if (Enable_trajectory_recording) {
+		for (const auto &item : excitons) {
+			recordTrajectoryEvent(&item, Trajectory_Recorder::Cycle_end);
+		}
+		for (const auto &item : electrons) {
+			recordTrajectoryEvent(&item, Trajectory_Recorder::Cycle_end);
+		}
+		for (const auto &item : holes) {
+			recordTrajectoryEvent(&item, Trajectory_Recorder::Cycle_end);
+		}
+	}
+	// Remove the remaining objects from the Simulation and free their sites
+	for (auto &item : excitons) {
+		removeObject(&item);
+		updateFreeSites(item.getCoords(), false);
+	}
+	for (auto &item : electrons) {
+		removeObject(&item);
+		updateFreeSites(item.getCoords(), false);
+	}
+	for (auto &item : holes) {
+		removeObject(&item);
+		updateFreeSites(item.getCoords(), false);
+	}
+	// Return all objects and their events to the pools, which moves the list nodes without deallocating them
+	exciton_pool.splice(exciton_pool.end(), excitons);
+	polaron_pool.splice(polaron_pool.end(), electrons);
+	polaron_pool.splice(polaron_pool.end(), holes);
+	exciton_hop_pool.splice(exciton_hop_pool.end(), exciton_hop_events);
+	exciton_recombination_pool.splice(exciton_recombination_pool.end(), exciton_recombination_events);
+	exciton_dissociation_pool.splice(exciton_dissociation_pool.end(), exciton_dissociation_events);
+	exciton_exciton_annihilation_pool.splice(exciton_exciton_annihilation_pool.end(), exciton_exciton_annihilation_events);
+	exciton_polaron_annihilation_pool.splice(exciton_polaron_annihilation_pool.end(), exciton_polaron_annihilation_events);
+	exciton_intersystem_crossing_pool.splice(exciton_intersystem_crossing_pool.end(), exciton_intersystem_crossing_events);
+	polaron_hop_pool.splice(polaron_hop_pool.end(), electron_hop_events);
+	polaron_hop_pool.splice(polaron_hop_pool.end(), hole_hop_events);
+	polaron_recombination_pool.splice(polaron_recombination_pool.end(), polaron_recombination_events);
+	polaron_extraction_pool.splice(polaron_extraction_pool.end(), electron_extraction_events);
+	polaron_extraction_pool.splice(polaron_extraction_pool.end(), hole_extraction_events);
+	N_excitons = 0;
+	N_singlets = 0;
+	N_triplets = 0;
+	N_electrons = 0;
+	N_holes = 0;
+	Transient_exciton_energy = 0;
+	Transient_electron_energy = 0;
+	Transient_hole_energy = 0;
 }
 
 bool OSC_Sim::siteContainsHole(const Coords& coords){
@@ -2686,130 +3320,126 @@ bool OSC_Sim::siteContainsHole(const Coords& coords){
     return false;
 }
 
-void OSC_Sim::updateTransientData() {
-	// ToF_positions_prev is a vector that stores the z-position of each charge carrier at the previous time interval
-	// Transient_xxxx_energies_prev is a vector that stores the energies of each object at the previous time interval
-	static const double step_size = 1.0 / (double)Transient_pnts_per_decade;
-	if (Enable_ToF_test) {
-		// Cheeck if enough time has passed since the previous time interval
-		if ((getTime() - Transient_creation_time) > transient_times[Transient_index_prev + 1]) {
-			int index = (int)floor((log10(getTime() - Transient_creation_time) - log10(Transient_start)) / step_size);
-			if (index >= (int)transient_times.size()) {
-				return;
-			}
-			// Update info for any previous timesteps that have elapsed already but were not accounted for
-			while (index != 0 && Transient_index_prev < index - 1 && (Transient_index_prev + 1) < (int)transient_times.size()) {
-				// electrons
-				if (!ToF_polaron_type) {
-					transient_electron_counts[Transient_index_prev + 1] += Transient_electron_counts_prev;
-					for (auto const &item : electrons) {
-						int electron_index = distance(transient_electron_tags.begin(), find(transient_electron_tags.begin(), transient_electron_tags.end(), item.getTag()));
-						// transient_velocities[index_prev+1] += 0;
-						transient_electron_energies[Transient_index_prev + 1] += transient_electron_energies_prev[electron_index];
-					}
-				}
-				// holes
-				else {
-					transient_hole_counts[Transient_index_prev + 1] += Transient_hole_counts_prev;
-					for (auto const &item : holes) {
-						int hole_index = distance(transient_hole_tags.begin(), find(transient_hole_tags.begin(), transient_hole_tags.end(), item.getTag()));
-						// transient_velocities[index_prev+1] += 0;
-						transient_hole_energies[Transient_index_prev + 1] += transient_hole_energies_prev[hole_index];
-					}
-				}
-				Transient_index_prev++;
-			}
-			// Update info for the current timestep
-			// electrons
-			if (!ToF_polaron_type) {
-				transient_electron_counts[index] += N_electrons;
-				Transient_electron_counts_prev = N_electrons;
-				for (auto const &item : electrons) {
-					// Get electron site energy and position for previous timestep
-					int electron_index = distance(transient_electron_tags.begin(), find(transient_electron_tags.begin(), transient_electron_tags.end(), item.getTag()));
-					transient_velocities[index] += (1e-7*lattice.getUnitSize()*(item.getCoords().z - ToF_positions_prev[electron_index])) / ((getTime() - Transient_creation_time) - transient_times[Transient_index_prev]);
-					transient_electron_energies[index] += getSiteEnergy(item.getCoords());
-					transient_electron_energies_prev[electron_index] = getSiteEnergy(item.getCoords());
-					ToF_positions_prev[electron_index] = item.getCoords().z;
-				}
-			}
-			// holes
-			else {
-				transient_hole_counts[index] += N_holes;
-				Transient_hole_counts_prev = N_holes;
-				for (auto const &item : holes) {
-					// Get hole site energy and position for previous timestep
-					int hole_index = distance(transient_hole_tags.begin(), find(transient_hole_tags.begin(), transient_hole_tags.end(), item.getTag()));
-					transient_velocities[index] += (1e-7*lattice.getUnitSize()*(item.getCoords().z - ToF_positions_prev[hole_index])) / ((getTime() - Transient_creation_time) - transient_times[Transient_index_prev]);
-					transient_hole_energies[index] += getSiteEnergy(item.getCoords());
-					transient_hole_energies_prev[hole_index] = getSiteEnergy(item.getCoords());
-					ToF_positions_prev[hole_index] = item.getCoords().z;
+void OSC_Sim::smoothIsingMorphology(const vector<unsigned char>& site_types_old, const int x_start, const int x_end, const vector<Coords>& neighbor_offsets, const vector<double>& neighbor_weights) {
+	Coords coords;
+	double weight_total;
+	for (int x = x_start; x < x_end; x++) {
+		for (int y = 0; y < lattice.getWidth(); y++) {
+			for (int z = 0; z < lattice.getHeight(); z++) {
+				coords.setXYZ(x, y, z);
+				long int site_index = lattice.getSiteIndex(coords);
+				// The site itself is counted as a like neighbor with unit weight
+				double weight_unlike = calculateIsingUnlikeWeight(site_types_old, coords, coords, site_types_old[site_index], neighbor_offsets, neighbor_weights, weight_total);
+				if ((weight_total - weight_unlike + 1.0) / (weight_total + 1.0) < Ising_smoothing_threshold) {
+					site_type_data[site_index] = (site_types_old[site_index] == 1) ? 2 : 1;
 				}
 			}
-			Transient_index_prev = index;
 		}
 	}
-	else if (Enable_dynamics_test) {
-		// Calculate data for next time step if enough time has elapsed
-		if ((getTime() - Transient_creation_time) > transient_times[Transient_index_prev + 1]) {
-			int index = (int)floor((log10(getTime() - Transient_creation_time) - log10(Transient_start)) / step_size);
-			if (index >= (int)transient_times.size()) {
-				return;
-			}
-			// Update info for any previous timesteps that have elapsed already but were not accounted for
-			while (index != 0 && Transient_index_prev < index - 1 && Transient_index_prev + 1 < (int)transient_times.size()) {
-				transient_singlet_counts[Transient_index_prev + 1] += Transient_singlet_counts_prev;
-				transient_triplet_counts[Transient_index_prev + 1] += Transient_triplet_counts_prev;
-				transient_electron_counts[Transient_index_prev + 1] += Transient_electron_counts_prev;
-				transient_hole_counts[Transient_index_prev + 1] += Transient_hole_counts_prev;
-				for (auto const &item : excitons) {
-					int exciton_index = distance(transient_exciton_tags.begin(), find(transient_exciton_tags.begin(), transient_exciton_tags.end(), item.getTag()));
-					transient_exciton_energies[Transient_index_prev + 1] += transient_exciton_energies_prev[exciton_index];
-				}
-				for (auto const &item : electrons) {
-					int electron_index = distance(transient_electron_tags.begin(), find(transient_electron_tags.begin(), transient_electron_tags.end(), item.getTag()));
-					transient_electron_energies[Transient_index_prev + 1] += transient_electron_energies_prev[electron_index];
-				}
-				for (auto const &item : holes) {
-					int hole_index = distance(transient_hole_tags.begin(), find(transient_hole_tags.begin(), transient_hole_tags.end(), item.getTag()));
-					transient_hole_energies[Transient_index_prev + 1] += transient_hole_energies_prev[hole_index];
-				}
-				Transient_index_prev++;
-			}
-			// Update info for the current timestep
-			transient_singlet_counts[index] += N_singlets;
-			transient_triplet_counts[index] += N_triplets;
-			transient_electron_counts[index] += N_electrons;
-			transient_hole_counts[index] += N_holes;
-			Transient_singlet_counts_prev = N_singlets;
-			Transient_triplet_counts_prev = N_triplets;
-			Transient_electron_counts_prev = N_electrons;
-			Transient_hole_counts_prev = N_holes;
-			for (auto &item : excitons) {
-				// Get polaron site energy and position for previous timestep
-				int exciton_index = distance(transient_exciton_tags.begin(), find(transient_exciton_tags.begin(), transient_exciton_tags.end(), item.getTag()));
-				transient_exciton_msdv[index] += intpow(1e-7*lattice.getUnitSize()*item.calculateDisplacement(), 2) / ((getTime() - Transient_creation_time) - transient_times[Transient_index_prev]);
-				item.resetInitialCoords(item.getCoords());
-				transient_exciton_energies[index] += getSiteEnergy(item.getCoords());
-				transient_exciton_energies_prev[exciton_index] = getSiteEnergy(item.getCoords());
+}
+
+void OSC_Sim::updateEffectiveSiteEnergies() {
+	// The effective energy of a carrier on a site combines the site energy, the internal potential, and the HOMO/LUMO level of the site type
+	// This sign convention reproduces the energy changes used for polaron hopping, so that E_delta = E_effective[dest] - E_effective[start]
+	if (Enable_procedural_dos) {
+		E_effective_electron.clear();
+		E_effective_hole.clear();
+		return;
+	}
+	E_effective_electron.assign(sites.size(), 0.0);
+	E_effective_hole.assign(sites.size(), 0.0);
+	for (long int n = 0, nmax = (long int)sites.size(); n < nmax; n++) {
+		Coords coords = lattice.getSiteCoords(n);
+		double E_site = sites[n].getEnergy();
+		if (getSiteType(n) == (short)1) {
+			E_effective_electron[n] = E_site + E_potential[coords.z] - Lumo_donor;
+			E_effective_hole[n] = E_site - E_potential[coords.z] - Homo_donor;
+		}
+		else {
+			E_effective_electron[n] = E_site + E_potential[coords.z] - Lumo_acceptor;
+			E_effective_hole[n] = E_site - E_potential[coords.z] - Homo_acceptor;
+		}
+	}
+}
+
+void OSC_Sim::updateFreeSites(const Coords& coords, const bool isOccupied) {
+	long int site_index = lattice.getSiteIndex(coords);
+	if (isOccupied) {
+		free_sites.removeSite(getSiteType(site_index), site_index);
+	}
+	else {
+		free_sites.addSite(getSiteType(site_index), site_index);
+	}
+	if (Enable_ToF_test && isToFInjectionSite(coords)) {
+		if (isOccupied) {
+			free_injection_sites.removeSite(0, coords.x*lattice.getWidth() + coords.y);
+		}
+		else {
+			free_injection_sites.addSite(0, coords.x*lattice.getWidth() + coords.y);
+		}
+	}
+}
+
+void OSC_Sim::updateIsingSlabs(const int slab_start, const int slab_end, const int N_slabs, vector<mt19937>& slab_generators, const vector<Coords>& neighbor_offsets, const vector<double>& neighbor_weights) {
+	Coords coords, coords_partner;
+	double weight_total, weight_total_partner;
+	uniform_int_distribution<int> dist_y(0, lattice.getWidth() - 1);
+	uniform_int_distribution<int> dist_z(0, lattice.getHeight() - 1);
+	uniform_int_distribution<int> dist_direction(0, 5);
+	uniform_real_distribution<double> dist_uniform(0.0, 1.0);
+	const int directions[6][3] = { { 1,0,0 },{ -1,0,0 },{ 0,1,0 },{ 0,-1,0 },{ 0,0,1 },{ 0,0,-1 } };
+	for (int slab = slab_start; slab < slab_end; slab += 2) {
+		mt19937& gen = slab_generators[slab];
+		int x_start = (slab*lattice.getLength()) / N_slabs;
+		int x_end = ((slab + 1)*lattice.getLength()) / N_slabs;
+		uniform_int_distribution<int> dist_x(x_start, x_end - 1);
+		long int N_attempts = (long int)(x_end - x_start)*lattice.getWidth()*lattice.getHeight();
+		for (long int n = 0; n < N_attempts; n++) {
+			coords.setXYZ(dist_x(gen), dist_y(gen), dist_z(gen));
+			const int* direction = directions[dist_direction(gen)];
+			if (!lattice.checkMoveValidity(coords, direction[0], direction[1], direction[2])) {
+				continue;
 			}
-			for (auto &item : electrons) {
-				// Get polaron site energy and position for previous timestep
-				int electron_index = distance(transient_electron_tags.begin(), find(transient_electron_tags.begin(), transient_electron_tags.end(), item.getTag()));
-				transient_electron_msdv[index] += intpow(1e-7*lattice.getUnitSize()*item.calculateDisplacement(), 2) / ((getTime() - Transient_creation_time) - transient_times[Transient_index_prev]);
-				item.resetInitialCoords(item.getCoords());
-				transient_electron_energies[index] += getSiteEnergy(item.getCoords());
-				transient_electron_energies_prev[electron_index] = getSiteEnergy(item.getCoords());
+			lattice.calculateDestinationCoords(coords, direction[0], direction[1], direction[2], coords_partner);
+			long int site_index = lattice.getSiteIndex(coords);
+			long int partner_index = lattice.getSiteIndex(coords_partner);
+			unsigned char type = site_type_data[site_index];
+			unsigned char type_partner = site_type_data[partner_index];
+			if (type == type_partner) {
+				continue;
 			}
-			for (auto &item : holes) {
-				// Get polaron site energy and position for previous timestep
-				int hole_index = distance(transient_hole_tags.begin(), find(transient_hole_tags.begin(), transient_hole_tags.end(), item.getTag()));
-				transient_hole_msdv[index] += intpow(1e-7*lattice.getUnitSize()*item.calculateDisplacement(), 2) / ((getTime() - Transient_creation_time) - transient_times[Transient_index_prev]);
-				item.resetInitialCoords(item.getCoords());
-				transient_hole_energies[index] += getSiteEnergy(item.getCoords());
-				transient_hole_energies_prev[hole_index] = getSiteEnergy(item.getCoords());
+			// Exchanging the two sites turns the unlike neighbors of each site into like neighbors and vice versa
+			double weight_unlike = calculateIsingUnlikeWeight(site_type_data, coords, coords_partner, type, neighbor_offsets, neighbor_weights, weight_total);
+			double weight_unlike_partner = calculateIsingUnlikeWeight(site_type_data, coords_partner, coords, type_partner, neighbor_offsets, neighbor_weights, weight_total_partner);
+			double E_delta = Ising_interaction_energy*((weight_total - 2 * weight_unlike) + (weight_total_partner - 2 * weight_unlike_partner));
+			if (E_delta <= 0 || dist_uniform(gen) < exp(-E_delta)) {
+				site_type_data[site_index] = type_partner;
+				site_type_data[partner_index] = type;
 			}
-			Transient_index_prev = index;
+		}
+	}
+}
+
+void OSC_Sim::updateTransientHop(const Object* object_ptr, const Coords& coords_initial, const double displacement_initial) {
+	// Hops are instantaneous, so the resulting changes in squared displacement and z-position are assigned to the time bin in which the hop occurs
+	const bool isBinned = Transient_index >= 0 && Transient_index < (int)transient_times.size();
+	const double bin_width = isBinned ? (transient_bins.getEdge(Transient_index + 1) - transient_bins.getEdge(Transient_index)) : 0.0;
+	const double energy_delta = getSiteEnergy(object_ptr->getCoords()) - getSiteEnergy(coords_initial);
+	const double msd_delta = intpow(1e-7*lattice.getUnitSize(), 2)*(intpow(object_ptr->calculateDisplacement(), 2) - intpow(displacement_initial, 2));
+	if (object_ptr->getObjectType().compare(Exciton::object_type) == 0) {
+		Transient_exciton_energy += energy_delta;
+		if (isBinned) {
+			transient_exciton_msdv[Transient_index] += msd_delta / bin_width;
+		}
+	}
+	else {
+		const bool charge = static_cast<const Polaron*>(object_ptr)->getCharge();
+		(charge ? Transient_hole_energy : Transient_electron_energy) += energy_delta;
+		if (isBinned && Enable_dynamics_test) {
+			(charge ? transient_hole_msdv : transient_electron_msdv)[Transient_index] += msd_delta / bin_width;
+		}
+		else if (isBinned && Enable_ToF_test) {
+			transient_velocities[Transient_index] += (1e-7*lattice.getUnitSize()*(object_ptr->getCoords().z - coords_initial.z)) / bin_width;
 		}
 	}
 }
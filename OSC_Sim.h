@@ -10,12 +10,23 @@
 #include "KMC_Lattice/Site.h"
 #include "Exciton.h"
 #include "Polaron.h"
+#include "FFT.h"
+#include "Free_Site_Lists.h"
+#include "Log_Bins.h"
+#include "Morphology.h"
+#include "Sample_Statistics.h"
+#include "Trajectory_Recorder.h"
 #include <algorithm>
 #include <numeric>
+#include <thread>
+#include <future>
+
+class OSC_Sim;
 
 struct Parameters_OPV : Parameters_Simulation{
     // Additional General Parameters
     double Internal_potential;
+    int N_threads;
     // Morphology Parameters
     bool Enable_neat; // Neat takes on donor properties
     bool Enable_bilayer;
@@ -23,8 +34,18 @@ struct Parameters_OPV : Parameters_Simulation{
     int Thickness_acceptor; // sites
     bool Enable_random_blend;
     double Acceptor_conc;
+    bool Enable_ising_blend;
+    double Ising_interaction_energy; // units of kT
+    int Ising_MC_steps;
+    double Ising_smoothing_threshold;
     bool Enable_import_morphology;
     std::ifstream* Morphology_file;
+    std::string Morphology_filename;
+    const Morphology_Header* Morphology_header = nullptr; // Preloaded morphology data that is used instead of the morphology file when set
+    const unsigned char* Morphology_packed_types = nullptr;
+    const unsigned char* Shared_site_types = nullptr; // Unpacked site types in a node-level shared memory window that are read directly instead of being copied
+    const OSC_Sim* Previous_sim = nullptr; // Simulation on the same lattice whose morphology and interface data are reused instead of being recreated
+    bool Enable_site_energy_reuse = false; // Also reuses the site energies of the previous simulation, which is only valid when the energetic disorder parameters are unchanged
     // Test Parameters
     int N_tests;
     bool Enable_exciton_diffusion_test;
@@ -36,6 +57,12 @@ struct Parameters_OPV : Parameters_Simulation{
     int ToF_pnts_per_decade;
     bool Enable_IQE_test;
     double IQE_time_cutoff;
+    int Raw_data_sample_size;
+    bool Enable_trajectory_recording;
+    int Trajectory_species_mask; // Bit i is set when the trajectories of species i (singlet, triplet, electron, hole) are recorded
+    int Trajectory_sampling_stride;
+    double Trajectory_sampling_probability;
+    Trajectory_Recorder* Trajectory_recorder = nullptr;
     bool Enable_dynamics_test;
     bool Enable_dynamics_extraction;
     double Dynamics_initial_exciton_conc;
@@ -99,11 +126,13 @@ struct Parameters_OPV : Parameters_Simulation{
     bool Enable_exponential_dos;
     double Energy_urbach_donor; // eV
     double Energy_urbach_acceptor; // eV
+	bool Enable_procedural_dos;
 	bool Enable_correlated_disorder;
 	double Disorder_correlation_length; // nm
 	bool Enable_gaussian_kernel;
 	bool Enable_power_kernel;
 	int Power_kernel_exponent; // must be negative
+	bool Enable_direct_convolution;
     // Coulomb Calculation Parameters
     double Dielectric_donor;
     double Dielectric_acceptor;
@@ -113,13 +142,10 @@ struct Parameters_OPV : Parameters_Simulation{
 class Site_OSC : public Site{
     public:
         double getEnergy() const{return *energy_it;}
-        short getType() const{return type;}
 		void setEnergy(const double energy) { *energy_it = energy; }
         void setEnergyIt(const std::vector<double>::iterator it){energy_it = it;}
-        void setType(const short site_type){type = site_type;}
     private:
 		std::vector<double>::iterator energy_it;
-        short type = 0; //  type 1 represent donor, type 2 represents acceptor
 };
 
 class OSC_Sim : public Simulation{
@@ -128,39 +154,42 @@ class OSC_Sim : public Simulation{
 		OSC_Sim();
 		virtual ~OSC_Sim();
         bool init(const Parameters_OPV& params,const int id);
+		void addTests(const int N_tests_added);
         double calculateDiffusionLength_avg() const;
         double calculateDiffusionLength_stdev() const;
 		std::vector<std::pair<double,double>> calculateDOSCorrelation(const double cutoff_radius);
-		std::vector<double> calculateTransitTimeDist(const std::vector<double>& data,const int counts) const;
         double calculateTransitTime_avg() const;
         double calculateTransitTime_stdev() const;
-		std::vector<double> calculateMobilities(const std::vector<double>& transit_times) const;
         double calculateMobility_avg() const;
         double calculateMobility_stdev() const;
         bool checkFinished() const;
 		bool checkParameters(const Parameters_OPV& params) const;
         bool executeNextEvent();
-		std::vector<double> getDiffusionData() const;
-		std::vector<std::pair<double, double>> getDOSCorrelationData() const;
+		Sample_Statistics getDiffusionStats() const;
+		std::vector<std::pair<double, double>> getDOSCorrelationData();
 		std::vector<double> getDynamicsExcitonEnergies() const;
 		std::vector<double> getDynamicsElectronEnergies() const;
 		std::vector<double> getDynamicsHoleEnergies() const;
-		std::vector<int> getDynamicsTransientSinglets() const;
-		std::vector<int> getDynamicsTransientTriplets() const;
-		std::vector<int> getDynamicsTransientElectrons() const;
-		std::vector<int> getDynamicsTransientHoles() const;
+		std::vector<double> getDynamicsTransientSinglets() const;
+		std::vector<double> getDynamicsTransientTriplets() const;
+		std::vector<double> getDynamicsTransientElectrons() const;
+		std::vector<double> getDynamicsTransientHoles() const;
 		std::vector<double> getDynamicsTransientTimes() const;
 		std::vector<double> getDynamicsExcitonMSDV() const;
 		std::vector<double> getDynamicsElectronMSDV() const;
 		std::vector<double> getDynamicsHoleMSDV() const;
+		double getInterfacialArea() const;
 		double getInternalField() const;
 		std::vector<double> getSiteEnergies(const short site_type) const;
 		std::vector<std::string> getChargeExtractionMap(const bool charge) const;
-		std::vector<int> getToFTransientCounts() const;
+		std::vector<double> getToFTransientCounts() const;
 		std::vector<double> getToFTransientEnergies() const;
 		std::vector<double> getToFTransientTimes() const;
 		std::vector<double> getToFTransientVelocities() const;
-		std::vector<double> getTransitTimeData() const;
+		Sample_Statistics getMobilityStats() const;
+		Sample_Statistics getTransitTimeStats() const;
+		int getN_interface_sites(const short site_type) const;
+		int getN_sites(const short site_type) const;
         int getN_excitons_created() const;
         int getN_excitons_created(const short site_type) const;
         int getN_excitons_dissociated() const;
@@ -187,6 +216,7 @@ class OSC_Sim : public Simulation{
     private:
         // Additional General Parameters
         double Internal_potential;
+        int N_threads;
         // Morphology Parameters
         bool Enable_neat; // Neat takes on donor properties
         bool Enable_bilayer;
@@ -194,8 +224,18 @@ class OSC_Sim : public Simulation{
         int Thickness_acceptor; // sites
         bool Enable_random_blend;
         double Acceptor_conc;
+        bool Enable_ising_blend;
+        double Ising_interaction_energy; // units of kT
+        int Ising_MC_steps;
+        double Ising_smoothing_threshold;
         bool Enable_import_morphology;
 		std::ifstream* Morphology_file;
+		std::string Morphology_filename;
+		const Morphology_Header* Morphology_header;
+		const unsigned char* Morphology_packed_types;
+		const unsigned char* Shared_site_types;
+		const OSC_Sim* Previous_sim;
+		bool Enable_site_energy_reuse;
         // Test Parameters
         int N_tests;
         bool Enable_exciton_diffusion_test;
@@ -207,6 +247,12 @@ class OSC_Sim : public Simulation{
         //int ToF_pnts_per_decade;
         bool Enable_IQE_test;
         double IQE_time_cutoff;
+        int Raw_data_sample_size;
+        bool Enable_trajectory_recording;
+        int Trajectory_species_mask;
+        int Trajectory_sampling_stride;
+        double Trajectory_sampling_probability;
+        Trajectory_Recorder* Trajectory_recorder;
         bool Enable_dynamics_test;
         bool Enable_dynamics_extraction;
         double Dynamics_initial_exciton_conc;
@@ -273,11 +319,13 @@ class OSC_Sim : public Simulation{
         bool Enable_exponential_dos;
         double Energy_urbach_donor;
         double Energy_urbach_acceptor;
+		bool Enable_procedural_dos;
 		bool Enable_correlated_disorder;
 		double Disorder_correlation_length; // nm
 		bool Enable_gaussian_kernel;
 		bool Enable_power_kernel;
 		int Power_kernel_exponent; // must be negative
+		bool Enable_direct_convolution;
         // Coulomb Calculation Parameters
         double Dielectric_donor;
         double Dielectric_acceptor;
@@ -289,11 +337,11 @@ class OSC_Sim : public Simulation{
         double R_exciton_generation_donor;
         double R_exciton_generation_acceptor;
 		double Transient_creation_time;
-		int Transient_index_prev;
-		int Transient_singlet_counts_prev;
-		int Transient_triplet_counts_prev;
-		int Transient_electron_counts_prev;
-		int Transient_hole_counts_prev;
+		int Transient_index;
+		double Transient_time_prev;
+		double Transient_exciton_energy = 0;
+		double Transient_electron_energy = 0;
+		double Transient_hole_energy = 0;
         // Site Data Structure
 		std::vector<Site_OSC> sites;
         // Object Data Structures
@@ -314,38 +362,60 @@ class OSC_Sim : public Simulation{
 		std::list<Polaron_Recombination> polaron_recombination_events;
 		std::list<Polaron_Extraction> electron_extraction_events;
 		std::list<Polaron_Extraction> hole_extraction_events;
+		// Pools of unused objects and events, whose list nodes are reused when new objects are created
+		std::list<Exciton> exciton_pool;
+		std::list<Polaron> polaron_pool;
+		std::list<Exciton_Hop> exciton_hop_pool;
+		std::list<Exciton_Recombination> exciton_recombination_pool;
+		std::list<Exciton_Dissociation> exciton_dissociation_pool;
+		std::list<Exciton_Exciton_Annihilation> exciton_exciton_annihilation_pool;
+		std::list<Exciton_Polaron_Annihilation> exciton_polaron_annihilation_pool;
+		std::list<Exciton_Intersystem_Crossing> exciton_intersystem_crossing_pool;
+		std::list<Polaron_Hop> polaron_hop_pool;
+		std::list<Polaron_Recombination> polaron_recombination_pool;
+		std::list<Polaron_Extraction> polaron_extraction_pool;
         // Additional Data Structures
 		std::vector<double> Coulomb_table;
 		std::vector<double> E_potential;
+		std::vector<double> E_effective_electron;
+		std::vector<double> E_effective_hole;
+		// Site types are stored separately from the sites so that they can be read from a shared memory window, type 1 represents donor, type 2 represents acceptor
+		std::vector<unsigned char> site_type_data;
+		const unsigned char* site_types = nullptr;
+		// Flags that indicate whether a site is within the exciton dissociation cutoff of a site of the opposite type
+		std::vector<unsigned char> site_interface_flags;
+		// Lists of the unoccupied donor and acceptor sites, and of the unoccupied time-of-flight injection sites indexed by x*Width + y
+		Free_Site_Lists free_sites;
+		Free_Site_Lists free_injection_sites;
 		std::vector<double> site_energies_donor;
 		std::vector<double> site_energies_acceptor;
 		std::vector<std::pair<double, double>> DOS_correlation_data;
-		std::vector<double> diffusion_distances;
-		std::vector<int> transient_exciton_tags;
-		std::vector<int> transient_electron_tags;
-		std::vector<int> transient_hole_tags;
-		std::vector<int> ToF_positions_prev;
-		std::vector<double> transient_exciton_energies_prev;
-		std::vector<double> transient_electron_energies_prev;
-		std::vector<double> transient_hole_energies_prev;
+		bool isDOSCorrelationCurrent = false;
+		unsigned long long Landscape_seed = 0;
+		Sample_Statistics diffusion_stats;
 		std::vector<double> transient_exciton_msdv;
 		std::vector<double> transient_electron_msdv;
 		std::vector<double> transient_hole_msdv;
 		std::vector<int> electron_extraction_data;
 		std::vector<int> hole_extraction_data;
 		std::vector<double> transient_times;
+		Log_Bins transient_bins;
 		std::vector<double> transient_velocities;
 		std::vector<double> transient_exciton_energies;
 		std::vector<double> transient_electron_energies;
 		std::vector<double> transient_hole_energies;
-		std::vector<double> transit_times;
-		std::vector<int> transient_singlet_counts;
-		std::vector<int> transient_triplet_counts;
-		std::vector<int> transient_electron_counts;
-		std::vector<int> transient_hole_counts;
+		Sample_Statistics transit_time_stats;
+		Sample_Statistics mobility_stats;
+		std::vector<double> transient_singlet_counts;
+		std::vector<double> transient_triplet_counts;
+		std::vector<double> transient_electron_counts;
+		std::vector<double> transient_hole_counts;
         // Additional Counters
         int N_donor_sites;
         int N_acceptor_sites;
+		long int N_interface_pairs = 0;
+		int N_donor_interface_sites = 0;
+		int N_acceptor_interface_sites = 0;
         int N_excitons_created = 0;
         int N_excitons_created_donor = 0;
         int N_excitons_created_acceptor = 0;
@@ -376,15 +446,34 @@ class OSC_Sim : public Simulation{
         int N_electron_surface_recombinations = 0;
         int N_hole_surface_recombinations = 0;
 		int N_transient_cycles = 0;
+		// Indicate whether the temporary events used for event calculations have been created for this simulation object
+		bool isExcitonEventsInitialized = false;
+		bool isPolaronEventsInitialized = false;
+		// Background energy landscape generation
+		std::mt19937 generator_landscape;
+		bool isLandscapeGeneratorSeeded = false;
+		// Declared last so that any pending landscape calculation finishes before the data it uses is destroyed
+		std::future<std::pair<std::vector<double>, std::vector<double>>> site_energies_next;
         // Additional Functions
+		void assignSiteEnergies();
 		double calculateCoulomb(const std::list<Polaron>::const_iterator polaron_it, const Coords& coords) const;
 		double calculateCoulomb(const bool charge, const Coords& coords) const;
+		void calculateCorrelatedEnergiesDirect(const std::vector<double>& energies, const long int site_start, const long int site_end, const std::vector<Coords>& offsets, const std::vector<double>& weights, const std::vector<int>& shell_indices, const int N_shells, std::vector<double>& new_energies);
+		std::vector<double> calculateCorrelatedEnergiesFFT(const std::vector<double>& energies, const std::vector<double>& kernel_weights, const int range);
+		void calculateCorrelationKernelParams(const double correlation_length, double& distance_max, double& scale_factor) const;
+		void calculateInterfaceData();
+		double calculateIsingUnlikeWeight(const std::vector<unsigned char>& types, const Coords& coords, const Coords& coords_partner, const unsigned char type, const std::vector<Coords>& neighbor_offsets, const std::vector<double>& neighbor_weights, double& weight_total) const;
+		double calculateProceduralSiteEnergy(const long int site_index) const;
         Coords calculateExcitonCreationCoords();
         void calculateExcitonEvents(Exciton* exciton_ptr);
         void calculateObjectListEvents(const std::vector<Object*>& object_ptr_vec);
         void calculatePolaronEvents(Polaron* polaron_ptr);
-		void createCorrelatedDOS(const double correlation_length);
+		void createCorrelatedDOS(const double correlation_length, std::vector<double>& energies_donor, std::vector<double>& energies_acceptor);
+		bool assignMorphologySiteTypes(const Morphology_Header& header, const unsigned char* packed_types);
         bool createImportedMorphology();
+		void createIsingMorphology();
+		void createSiteEnergies(std::vector<double>& energies_donor, std::vector<double>& energies_acceptor, std::mt19937& gen);
+		std::pair<std::vector<double>, std::vector<double>> createSiteEnergiesNext();
         void deleteObject(Object* object_ptr);
         // Exciton Event Execution Functions
         bool executeExcitonCreation();
@@ -400,18 +489,43 @@ class OSC_Sim : public Simulation{
         bool executePolaronHop(const std::list<Event*>::const_iterator event_it);
         bool executePolaronRecombination(const std::list<Event*>::const_iterator event_it);
         bool executePolaronExtraction(const std::list<Event*>::const_iterator event_it);
-        Coords generateExciton();
+        void generateExciton(const Coords& coords);
         void generateElectron(const Coords& coords,int tag);
         void generateHole(const Coords& coords,int tag);
         void generateDynamicsExcitons();
         void generateToFPolarons();
 		std::list<Exciton>::iterator getExcitonIt(const Object* object_ptr);
 		std::list<Polaron>::iterator getPolaronIt(const Object* object_ptr);
+		double getEffectiveSiteEnergy(const bool charge, const long int site_index) const;
         double getSiteEnergy(const Coords& coords) const;
         short getSiteType(const Coords& coords) const;
+		short getSiteType(const long int site_index) const { return (short)site_types[site_index]; }
+		static double hashToUniform(const unsigned long long seed, const unsigned long long counter);
         bool initializeArchitecture();
+		void initializeFreeSites();
+		void integrateTransientData(const double time);
+		bool isToFInjectionSite(const Coords& coords) const;
+		void recordTrajectoryEvent(const Object* object_ptr, const unsigned char event_type);
+		void setSiteType(const long int site_index, const short site_type) { site_type_data[site_index] = (unsigned char)site_type; }
+		void resetTransientCycle();
         bool siteContainsHole(const Coords& coords);
-        void updateTransientData();
+		void smoothIsingMorphology(const std::vector<unsigned char>& site_types_old, const int x_start, const int x_end, const std::vector<Coords>& neighbor_offsets, const std::vector<double>& neighbor_weights);
+		void updateEffectiveSiteEnergies();
+		void updateFreeSites(const Coords& coords, const bool isOccupied);
+
+		// Adds a copy of the item to the end of the list, moving an unused node from the pool instead of allocating a new one when possible
+		template<typename T>
+		static void pushBackRecycled(std::list<T>& items, std::list<T>& pool, const T& item) {
+			if (pool.empty()) {
+				items.push_back(item);
+			}
+			else {
+				items.splice(items.end(), pool, pool.begin());
+				items.back() = item;
+			}
+		}
+		void updateIsingSlabs(const int slab_start, const int slab_end, const int N_slabs, std::vector<std::mt19937>& slab_generators, const std::vector<Coords>& neighbor_offsets, const std::vector<double>& neighbor_weights);
+		void updateTransientHop(const Object* object_ptr, const Coords& coords_initial, const double displacement_initial);
 };
 
 #endif //OSC_SIM_H
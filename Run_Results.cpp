@@ -0,0 +1,72 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Run_Results.h"
+#include <algorithm>
+
+using namespace std;
+
+void Run_Results::combineBuffers(const double* input, double* output, const int) {
+	// The header is identical on all processors and is left unchanged
+	int N_summed = (int)output[0];
+	int N_stats = (int)output[1];
+	int offset = 2 + N_stats;
+	for (int i = 0; i < N_summed; i++) {
+		output[offset + i] += input[offset + i];
+	}
+	offset += N_summed;
+	for (int k = 0; k < N_stats; k++) {
+		int N_moments = (int)output[2 + k];
+		Sample_Statistics::mergeMoments(input + offset, output + offset, N_moments);
+		offset += N_moments;
+	}
+}
+
+Run_Results Run_Results::combine(Communicator& comm) const {
+	Run_Results combined = *this;
+	vector<double> buffer = pack();
+	comm.reduce(buffer, &Run_Results::combineBuffers, 0);
+	if (comm.getRank() == 0) {
+		combined.unpack(buffer);
+	}
+	return combined;
+}
+
+vector<double> Run_Results::pack() const {
+	// Buffer layout: number of summed values, number of statistics, size of each statistics block, summed values, statistics blocks
+	int N_summed = N_counters;
+	for (const auto& item : data_vectors) {
+		N_summed += (int)item.size();
+	}
+	vector<double> buffer;
+	buffer.push_back((double)N_summed);
+	buffer.push_back((double)N_statistics);
+	for (const auto& item : statistics) {
+		buffer.push_back((double)item.getMoments().size());
+	}
+	buffer.insert(buffer.end(), counters.begin(), counters.end());
+	for (const auto& item : data_vectors) {
+		buffer.insert(buffer.end(), item.begin(), item.end());
+	}
+	for (const auto& item : statistics) {
+		buffer.insert(buffer.end(), item.getMoments().begin(), item.getMoments().end());
+	}
+	return buffer;
+}
+
+void Run_Results::unpack(const vector<double>& buffer) {
+	auto it = buffer.begin() + 2 + N_statistics;
+	copy(it, it + N_counters, counters.begin());
+	it += N_counters;
+	for (auto& item : data_vectors) {
+		copy(it, it + item.size(), item.begin());
+		it += item.size();
+	}
+	for (auto& item : statistics) {
+		vector<double> moments(it, it + item.getMoments().size());
+		it += moments.size();
+		item.setMoments(moments);
+	}
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef RUN_RESULTS_H
+#define RUN_RESULTS_H
+
+#include "Communicator.h"
+#include "Sample_Statistics.h"
+#include <vector>
+
+//! \brief This class holds all of the end-of-run counters, data vectors, and sample statistics of a processor.
+//! \details The same object is used to write the results file of each processor and, after being combined from all processors, the analysis summary,
+//! so that the two outputs are always calculated from the same data.  Counters and data vectors are summed and sample statistics are merged,
+//! and all of them are combined with a single reduction of one flat buffer.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Run_Results {
+	public:
+		//! The scalar values that are summed over all processors.
+		enum Counter {
+			Elapsed_time,
+			Morphology_load_time,
+			Morphology_broadcast_time,
+			Initialization_time,
+			Morphology_readers,
+			N_transient_cycles,
+			Transit_attempts,
+			Polarons_collected,
+			Excitons_tested,
+			Excitons_created,
+			Excitons_created_donor,
+			Excitons_created_acceptor,
+			Excitons_dissociated,
+			Singlet_excitons_recombined,
+			Triplet_excitons_recombined,
+			Singlet_singlet_annihilations,
+			Singlet_triplet_annihilations,
+			Triplet_triplet_annihilations,
+			Singlet_polaron_annihilations,
+			Triplet_polaron_annihilations,
+			Geminate_recombinations,
+			Bimolecular_recombinations,
+			Electrons_collected,
+			Holes_collected,
+			N_counters
+		};
+
+		//! The data vectors that are summed element by element over all processors.
+		enum Data_Vector {
+			ToF_transient_counts,
+			ToF_transient_energies,
+			ToF_transient_velocities,
+			Dynamics_transient_singlets,
+			Dynamics_transient_triplets,
+			Dynamics_transient_electrons,
+			Dynamics_transient_holes,
+			Dynamics_exciton_energies,
+			Dynamics_electron_energies,
+			Dynamics_hole_energies,
+			Dynamics_exciton_msdv,
+			Dynamics_electron_msdv,
+			Dynamics_hole_msdv,
+			Tests_claimed, // One element per processor, with each processor only setting its own element
+			N_data_vectors
+		};
+
+		//! The sample statistics that are merged over all processors.
+		enum Statistic {
+			Diffusion_lengths,
+			Transit_times,
+			Mobilities,
+			N_statistics
+		};
+
+		double getCounter(const Counter counter) const { return counters[counter]; }
+		int getCount(const Counter counter) const { return (int)counters[counter]; }
+		void setCounter(const Counter counter, const double value) { counters[counter] = value; }
+		const std::vector<double>& getDataVector(const Data_Vector index) const { return data_vectors[index]; }
+		void setDataVector(const Data_Vector index, const std::vector<double>& data) { data_vectors[index] = data; }
+		const Sample_Statistics& getStatistics(const Statistic index) const { return statistics[index]; }
+		void setStatistics(const Statistic index, const Sample_Statistics& stats) { statistics[index] = stats; }
+
+		//! \brief Combines the results from all processors of the communicator with one reduction.
+		//! \details The data vectors and sample statistics must have the same sizes on all processors.
+		//! \return The combined results on processor 0 and an unchanged copy on all other processors.
+		Run_Results combine(Communicator& comm) const;
+
+	private:
+		std::vector<double> counters = std::vector<double>(N_counters, 0.0);
+		std::vector<std::vector<double>> data_vectors = std::vector<std::vector<double>>(N_data_vectors);
+		std::vector<Sample_Statistics> statistics = std::vector<Sample_Statistics>(N_statistics);
+
+		static void combineBuffers(const double* input, double* output, const int N_values);
+		std::vector<double> pack() const;
+		void unpack(const std::vector<double>& buffer);
+};
+
+#endif // RUN_RESULTS_H
@@ -0,0 +1,60 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Sample_Statistics.h"
+#include <cmath>
+
+using namespace std;
+
+void Sample_Statistics::init(const Log_Bins& bins, const int reservoir_size, const unsigned int seed) {
+	histogram_bins = bins;
+	moments.assign(3 + bins.getN_bins(), 0.0);
+	Reservoir_size = reservoir_size;
+	reservoir.clear();
+	reservoir_generator.seed(seed);
+}
+
+void Sample_Statistics::addValue(const double value) {
+	// Welford update of the count, mean, and sum of squared deviations
+	moments[0] += 1.0;
+	double delta = value - moments[1];
+	moments[1] += delta / moments[0];
+	moments[2] += delta*(value - moments[1]);
+	int bin_index = histogram_bins.getBinIndex(value);
+	if (bin_index >= 0 && bin_index < histogram_bins.getN_bins()) {
+		moments[3 + bin_index] += 1.0;
+	}
+	// Reservoir sampling keeps each value with equal probability
+	if (Reservoir_size > 0) {
+		if ((int)reservoir.size() < Reservoir_size) {
+			reservoir.push_back(value);
+		}
+		else {
+			uniform_int_distribution<long long> dist(0, getCount() - 1);
+			long long index = dist(reservoir_generator);
+			if (index < Reservoir_size) {
+				reservoir[index] = value;
+			}
+		}
+	}
+}
+
+double Sample_Statistics::getStdev() const {
+	return sqrt(moments[2] / (moments[0] - 1.0));
+}
+
+void Sample_Statistics::mergeMoments(const double* input, double* output, const int N_values) {
+	double count = input[0] + output[0];
+	if (count > 0) {
+		// Chan et al. pairwise combination of the means and sums of squared deviations
+		double delta = input[1] - output[1];
+		output[2] += input[2] + delta*delta*input[0] * output[0] / count;
+		output[1] += delta*input[0] / count;
+		output[0] = count;
+	}
+	for (int i = 3; i < N_values; i++) {
+		output[i] += input[i];
+	}
+}
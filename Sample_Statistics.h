@@ -0,0 +1,68 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef SAMPLE_STATISTICS_H
+#define SAMPLE_STATISTICS_H
+
+#include "Log_Bins.h"
+#include <random>
+#include <vector>
+
+//! \brief This class accumulates the statistics of a stream of sample values without storing the whole sample.
+//! \details The mean and variance are updated with Welford's algorithm and the values are counted in a histogram of log-spaced bins, so the
+//! memory use does not depend on the number of values.  A capped random sample of the raw values can optionally be kept using reservoir sampling.
+//! Accumulators on different processors are combined by merging their packed moments, which have a fixed size, in one reduction of the Run_Results class.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Sample_Statistics {
+	public:
+		//! \brief Initializes an empty accumulator.
+		//! \param bins defines the histogram bins, which can be an empty set of bins to disable the histogram.
+		//! \param reservoir_size is the maximum number of raw values that are kept, which can be zero to disable the raw value sample.
+		//! \param seed is the seed for the random number generator used to choose the raw values that are kept.
+		void init(const Log_Bins& bins, const int reservoir_size, const unsigned int seed);
+
+		//! \brief Adds a value to the accumulator.
+		//! \details Values outside of the histogram range are included in the moments but are not counted in the histogram.
+		void addValue(const double value);
+
+		//! \brief Gets the number of values that have been added.
+		long long getCount() const { return (long long)moments[0]; }
+
+		//! \brief Gets the histogram of the values, with one count per value that fell inside the histogram range.
+		std::vector<double> getHistogram() const { return std::vector<double>(moments.begin() + 3, moments.end()); }
+
+		//! \brief Gets the mean of the values.
+		double getMean() const { return moments[1]; }
+
+		//! \brief Gets the packed count, mean, sum of squared deviations, and histogram counts of the accumulator.
+		const std::vector<double>& getMoments() const { return moments; }
+
+		//! \brief Gets the raw value sample.
+		const std::vector<double>& getReservoir() const { return reservoir; }
+
+		//! \brief Gets the sample standard deviation of the values.
+		double getStdev() const;
+
+		//! \brief Combines two sets of packed moments.
+		//! \param input is the first set of packed moments.
+		//! \param output is the second set of packed moments, which is replaced by the combined moments.
+		//! \param N_values is the number of values in each set of packed moments.
+		static void mergeMoments(const double* input, double* output, const int N_values);
+
+		//! \brief Replaces the packed moments, which must have the same size as the current moments.
+		void setMoments(const std::vector<double>& moments_new) { moments = moments_new; }
+
+	private:
+		// The count, mean, and sum of squared deviations are followed by the histogram counts, so that the whole accumulator is reduced as one item
+		std::vector<double> moments = std::vector<double>(3, 0.0);
+		Log_Bins histogram_bins;
+		int Reservoir_size = 0;
+		std::vector<double> reservoir;
+		std::mt19937 reservoir_generator;
+};
+
+#endif // SAMPLE_STATISTICS_H
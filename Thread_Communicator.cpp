@@ -0,0 +1,237 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Thread_Communicator.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+Thread_Communicator::Group::Group(const int N_threads) : size(N_threads), slots(N_threads, nullptr), split_groups(N_threads), counter(0), time_start(chrono::steady_clock::now()) {}
+
+Thread_Communicator::Thread_Communicator(const shared_ptr<Group>& group_in, const int rank_in) : group(group_in), rank(rank_in) {}
+
+vector<unique_ptr<Thread_Communicator>> Thread_Communicator::create(const int N_threads) {
+	shared_ptr<Group> group_new(new Group(N_threads));
+	vector<unique_ptr<Thread_Communicator>> comms;
+	for (int i = 0; i < N_threads; i++) {
+		comms.push_back(unique_ptr<Thread_Communicator>(new Thread_Communicator(group_new, i)));
+	}
+	return comms;
+}
+
+int Thread_Communicator::getSize() const {
+	return group->size;
+}
+
+double Thread_Communicator::getWallTime() const {
+	return chrono::duration<double>(chrono::steady_clock::now() - group->time_start).count();
+}
+
+void Thread_Communicator::abort() {
+	// The other threads may be waiting in a collective operation, so the whole process is ended immediately
+	cout.flush();
+	_Exit(1);
+}
+
+void Thread_Communicator::barrier() {
+	unique_lock<mutex> lock(group->mutex);
+	long int generation = group->barrier_generation;
+	group->N_waiting++;
+	if (group->N_waiting == group->size) {
+		group->N_waiting = 0;
+		group->barrier_generation++;
+		group->condition.notify_all();
+	}
+	else {
+		group->condition.wait(lock, [&] { return group->barrier_generation != generation; });
+	}
+}
+
+void Thread_Communicator::broadcast(void* data, const size_t size_bytes, const int root) {
+	if (rank == root) {
+		group->slots[root] = data;
+	}
+	barrier();
+	if (rank != root && size_bytes > 0) {
+		memcpy(data, group->slots[root], size_bytes);
+	}
+	barrier();
+}
+
+vector<int> Thread_Communicator::gather(const int value, const int root) {
+	vector<int> values;
+	group->slots[rank] = &value;
+	barrier();
+	if (rank == root) {
+		for (int i = 0; i < group->size; i++) {
+			values.push_back(*static_cast<const int*>(group->slots[i]));
+		}
+	}
+	barrier();
+	return values;
+}
+
+vector<string> Thread_Communicator::gather(const string& value, const int root) {
+	vector<string> values;
+	group->slots[rank] = &value;
+	barrier();
+	if (rank == root) {
+		for (int i = 0; i < group->size; i++) {
+			values.push_back(*static_cast<const string*>(group->slots[i]));
+		}
+	}
+	barrier();
+	return values;
+}
+
+vector<unsigned char> Thread_Communicator::sendReceive(const vector<unsigned char>& data, const int dest, const int source) {
+	// Sent messages are queued in the group context, so sending never blocks and the messages of each pair of threads stay in order
+	vector<unsigned char> data_receive;
+	unique_lock<mutex> lock(group->mutex);
+	if (dest >= 0) {
+		group->messages[make_pair(rank, dest)].push_back(data);
+		group->condition.notify_all();
+	}
+	if (source >= 0) {
+		deque<vector<unsigned char>>& queue = group->messages[make_pair(source, rank)];
+		group->condition.wait(lock, [&] { return !queue.empty(); });
+		data_receive.swap(queue.front());
+		queue.pop_front();
+	}
+	return data_receive;
+}
+
+vector<vector<unsigned char>> Thread_Communicator::exchangeAll(const vector<vector<unsigned char>>& data) {
+	vector<vector<unsigned char>> data_all;
+	group->slots[rank] = &data;
+	barrier();
+	for (int i = 0; i < group->size; i++) {
+		data_all.push_back((*static_cast<const vector<vector<unsigned char>>*>(group->slots[i]))[rank]);
+	}
+	barrier();
+	return data_all;
+}
+
+void Thread_Communicator::reduce(vector<double>& data, Reduce_Function function, const int root) {
+	// The data is combined in the same rank order as in the MPI_Communicator class
+	const int N_values = (int)data.size();
+	vector<double> data_combined;
+	group->slots[rank] = data.data();
+	barrier();
+	if (rank == root) {
+		const double* data_last = static_cast<const double*>(group->slots[group->size - 1]);
+		data_combined.assign(data_last, data_last + N_values);
+		for (int i = group->size - 2; i >= 0; i--) {
+			function(static_cast<const double*>(group->slots[i]), data_combined.data(), N_values);
+		}
+	}
+	barrier();
+	if (rank == root) {
+		data = data_combined;
+	}
+}
+
+void Thread_Communicator::startSum(const int* input, int* output, const int count) {
+	// Each sum is identified by its index, so that threads that start the next sum before all threads have read the previous one do not mix them
+	lock_guard<mutex> lock(group->mutex);
+	Sum_State& sum = group->sums[sum_index];
+	sum.values.resize(count, 0);
+	for (int i = 0; i < count; i++) {
+		sum.values[i] += input[i];
+	}
+	sum.N_contributions++;
+	if (sum.N_contributions == group->size) {
+		group->condition.notify_all();
+	}
+	sum_output = output;
+	isSumStarted = true;
+}
+
+bool Thread_Communicator::completeSum() {
+	// The group mutex must be locked by the caller
+	auto it = group->sums.find(sum_index);
+	if (it->second.N_contributions < group->size) {
+		return false;
+	}
+	copy(it->second.values.begin(), it->second.values.end(), sum_output);
+	it->second.N_reads++;
+	if (it->second.N_reads == group->size) {
+		group->sums.erase(it);
+	}
+	sum_index++;
+	isSumStarted = false;
+	return true;
+}
+
+bool Thread_Communicator::testSum() {
+	lock_guard<mutex> lock(group->mutex);
+	return completeSum();
+}
+
+void Thread_Communicator::waitSum() {
+	unique_lock<mutex> lock(group->mutex);
+	group->condition.wait(lock, [&] { return completeSum(); });
+}
+
+void Thread_Communicator::createCounter() {
+	resetCounter();
+}
+
+long int Thread_Communicator::fetchAndAddCounter(const long int increment) {
+	return group->counter.fetch_add(increment);
+}
+
+void Thread_Communicator::resetCounter() {
+	barrier();
+	if (rank == 0) {
+		group->counter = 0;
+	}
+	barrier();
+}
+
+unique_ptr<Communicator> Thread_Communicator::split(const int color) {
+	// The lowest ranked thread of each color creates the context of the new group, and the other threads of the same color take it from the leader
+	group->slots[rank] = &color;
+	barrier();
+	int leader = -1;
+	int rank_new = 0;
+	int size_new = 0;
+	for (int i = 0; i < group->size; i++) {
+		if (*static_cast<const int*>(group->slots[i]) == color) {
+			if (leader < 0) {
+				leader = i;
+			}
+			if (i < rank) {
+				rank_new++;
+			}
+			size_new++;
+		}
+	}
+	if (rank == leader) {
+		group->split_groups[rank] = shared_ptr<Group>(new Group(size_new));
+	}
+	barrier();
+	unique_ptr<Communicator> comm_new(new Thread_Communicator(group->split_groups[leader], rank_new));
+	barrier();
+	if (rank == leader) {
+		group->split_groups[rank].reset();
+	}
+	return comm_new;
+}
+
+const unsigned char* Thread_Communicator::createSharedArray(const size_t size_bytes, const function<void(unsigned char*)>& fill) {
+	// The array is owned by the group context, so that it remains valid until the communicators of all threads have been destroyed
+	if (rank == 0) {
+		group->shared_arrays.push_back(vector<unsigned char>(size_bytes));
+		fill(group->shared_arrays.back().data());
+		group->slots[0] = group->shared_arrays.back().data();
+	}
+	barrier();
+	const unsigned char* data = static_cast<const unsigned char*>(group->slots[0]);
+	barrier();
+	return data;
+}
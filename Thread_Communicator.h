@@ -0,0 +1,91 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef THREAD_COMMUNICATOR_H
+#define THREAD_COMMUNICATOR_H
+
+#include "Communicator.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+
+//! \brief This class implements the Communicator interface without MPI, with each processor being a thread of a single process.
+//! \details The communicators of a group share a context that holds the synchronization objects and the data published by each thread.
+//! Collective operations publish a pointer to the data of each thread and exchange the data between barriers, so no data is copied
+//! that would not also be sent by MPI.  The group of communicators is created with the create function before the threads are started.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Thread_Communicator : public Communicator {
+	public:
+		//! \brief Creates a group of communicators, one for each thread.
+		//! \param N_threads is the number of threads, which must be at least one.
+		//! \return The communicators in rank order.
+		static std::vector<std::unique_ptr<Thread_Communicator>> create(const int N_threads);
+
+		int getRank() const { return rank; }
+		int getSize() const;
+		double getWallTime() const;
+		void abort();
+		void barrier();
+		void broadcast(void* data, const size_t size, const int root);
+		std::vector<int> gather(const int value, const int root);
+		std::vector<std::string> gather(const std::string& value, const int root);
+		std::vector<unsigned char> sendReceive(const std::vector<unsigned char>& data, const int dest, const int source);
+		std::vector<std::vector<unsigned char>> exchangeAll(const std::vector<std::vector<unsigned char>>& data);
+		void reduce(std::vector<double>& data, Reduce_Function function, const int root);
+		void startSum(const int* input, int* output, const int count);
+		bool isSumPending() const { return isSumStarted; }
+		bool testSum();
+		void waitSum();
+		void createCounter();
+		long int fetchAndAddCounter(const long int increment);
+		void resetCounter();
+		void freeCounter() {}
+		void freeSharedArrays() {}
+		std::unique_ptr<Communicator> split(const int color);
+		std::unique_ptr<Communicator> splitShared(const int color) { return split(color); }
+		const unsigned char* createSharedArray(const size_t size, const std::function<void(unsigned char*)>& fill);
+
+	private:
+		struct Sum_State {
+			std::vector<int> values;
+			int N_contributions = 0;
+			int N_reads = 0;
+		};
+
+		struct Group {
+			int size;
+			std::mutex mutex;
+			std::condition_variable condition;
+			int N_waiting = 0;
+			long int barrier_generation = 0;
+			// One published pointer per thread, which is only valid between the barriers of a collective operation
+			std::vector<const void*> slots;
+			std::vector<std::shared_ptr<Group>> split_groups;
+			std::map<long int, Sum_State> sums;
+			// Point-to-point messages that have been sent but not yet received, for each pair of source and destination ranks
+			std::map<std::pair<int, int>, std::deque<std::vector<unsigned char>>> messages;
+			std::atomic<long int> counter;
+			std::vector<std::vector<unsigned char>> shared_arrays;
+			std::chrono::steady_clock::time_point time_start;
+			explicit Group(const int N_threads);
+		};
+
+		std::shared_ptr<Group> group;
+		int rank;
+		long int sum_index = 0;
+		bool isSumStarted = false;
+		int* sum_output = nullptr;
+
+		Thread_Communicator(const std::shared_ptr<Group>& group, const int rank);
+		bool completeSum();
+};
+
+#endif // THREAD_COMMUNICATOR_H
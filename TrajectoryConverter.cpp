@@ -0,0 +1,65 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Trajectory_Recorder.h"
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Converts binary trajectory files created by Excimontec into CSV files.
+// Usage: TrajectoryConverter.exe input_file [output_file]
+// When no output filename is given, the extension of the input filename is replaced with .csv.
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		cout << "Usage: TrajectoryConverter.exe input_file [output_file]" << endl;
+		return 1;
+	}
+	string input_filename = argv[1];
+	string output_filename;
+	if (argc == 3) {
+		output_filename = argv[2];
+	}
+	else {
+		size_t pos = input_filename.find_last_of('.');
+		output_filename = (pos == string::npos ? input_filename : input_filename.substr(0, pos)) + ".csv";
+	}
+	ifstream input_file(input_filename.c_str(), ifstream::in | ifstream::binary);
+	if (!input_file.good()) {
+		cout << "Error opening trajectory file " << input_filename << " for conversion." << endl;
+		return 1;
+	}
+	string error_message;
+	if (!Trajectory_Recorder::readHeader(input_file, error_message)) {
+		cout << "Error! " << error_message << endl;
+		return 1;
+	}
+	ofstream output_file(output_filename.c_str(), ofstream::out | ofstream::trunc);
+	if (!output_file.good()) {
+		cout << "Error creating CSV file " << output_filename << "." << endl;
+		return 1;
+	}
+	output_file.precision(numeric_limits<double>::max_digits10);
+	output_file << "Time (s),Tag,Species,Site Index,Event Type,Energy (eV)" << endl;
+	// Records are read in large blocks
+	vector<Trajectory_Record> records(65536);
+	long long N_records = 0;
+	while (input_file) {
+		input_file.read(reinterpret_cast<char*>(records.data()), records.size()*sizeof(Trajectory_Record));
+		long long N_read = (long long)input_file.gcount() / (long long)sizeof(Trajectory_Record);
+		for (long long n = 0; n < N_read; n++) {
+			const Trajectory_Record& record = records[n];
+			output_file << record.time << "," << record.tag << "," << Trajectory_Recorder::getSpeciesName(record.species) << "," << record.site_index << ",";
+			output_file << Trajectory_Recorder::getEventTypeName(record.event_type) << "," << record.energy << "\n";
+		}
+		N_records += N_read;
+	}
+	output_file.close();
+	cout << "Converted " << N_records << " trajectory records from " << input_filename << " to " << output_filename << "." << endl;
+	return 0;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#include "Trajectory_Recorder.h"
+#include <cstring>
+
+using namespace std;
+
+const char Trajectory_Recorder::Format_id[8] = { 'E','X','C','T','R','A','J','\0' };
+
+Trajectory_Recorder::~Trajectory_Recorder() {
+	close();
+}
+
+void Trajectory_Recorder::close() {
+	if (file.is_open()) {
+		flush();
+		file.close();
+	}
+}
+
+void Trajectory_Recorder::flush() {
+	file.write(reinterpret_cast<const char*>(buffer.data()), N_buffered*sizeof(Trajectory_Record));
+	N_buffered = 0;
+}
+
+string Trajectory_Recorder::getEventTypeName(const uint8_t event_type) {
+	static const char* names[] = { "creation", "hop", "intersystem crossing", "recombination", "dissociation", "annihilation", "extraction", "cycle end" };
+	return (event_type < 8) ? names[event_type] : "unknown";
+}
+
+string Trajectory_Recorder::getSpeciesName(const uint8_t species) {
+	static const char* names[] = { "singlet", "triplet", "electron", "hole" };
+	return (species < 4) ? names[species] : "unknown";
+}
+
+bool Trajectory_Recorder::open(const string& filename, const int buffer_size) {
+	close();
+	file.open(filename.c_str(), ofstream::out | ofstream::binary | ofstream::trunc);
+	if (!file.good()) {
+		return false;
+	}
+	Trajectory_Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.format_id, Format_id, sizeof(Format_id));
+	header.version = Format_version;
+	header.record_size = (int32_t)sizeof(Trajectory_Record);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	Trajectory_Record empty_record;
+	memset(&empty_record, 0, sizeof(empty_record));
+	buffer.assign(buffer_size, empty_record);
+	N_buffered = 0;
+	return file.good();
+}
+
+bool Trajectory_Recorder::readHeader(istream& input, string& error_message) {
+	Trajectory_Header header;
+	if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		error_message = "Trajectory file is too small to contain a valid header.";
+		return false;
+	}
+	if (memcmp(header.format_id, Format_id, sizeof(Format_id)) != 0) {
+		error_message = "Trajectory file format not recognized.";
+		return false;
+	}
+	if (header.version != Format_version || header.record_size != (int32_t)sizeof(Trajectory_Record)) {
+		error_message = "Trajectory file version is not supported.";
+		return false;
+	}
+	return true;
+}
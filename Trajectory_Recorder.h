@@ -0,0 +1,97 @@
+// Copyright (c) 2018 Michael C. Heiber
+// This source file is part of the Excimontec project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
+
+#ifndef TRAJECTORY_RECORDER_H
+#define TRAJECTORY_RECORDER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//! \brief This struct is the fixed-width binary record of a single event in the trajectory of an exciton or charge carrier.
+struct Trajectory_Record {
+	double time;
+	double energy;
+	int64_t site_index;
+	int32_t tag;
+	uint8_t species;
+	uint8_t event_type;
+	uint8_t reserved[2];
+};
+
+//! \brief This struct is the fixed size header at the start of a binary trajectory file, which is followed by the trajectory records.
+struct Trajectory_Header {
+	char format_id[8];
+	int32_t version;
+	int32_t record_size;
+};
+
+//! \brief This class buffers trajectory records in memory and writes them to a binary trajectory file in large blocks.
+//! \details Records are appended to a fixed capacity buffer, and the whole buffer is written to the file with a single write once it is full,
+//! so recording an event only costs a copy into memory.
+//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+//! \author Michael C. Heiber
+//! \date 2018
+class Trajectory_Recorder {
+	public:
+		//! The species codes stored in the trajectory records.
+		enum Species : uint8_t { Singlet = 0, Triplet = 1, Electron = 2, Hole = 3 };
+
+		//! The event type codes stored in the trajectory records.
+		enum Event_Type : uint8_t { Creation = 0, Hop = 1, Intersystem_crossing = 2, Recombination = 3, Dissociation = 4, Annihilation = 5, Extraction = 6, Cycle_end = 7 };
+
+		//! The identifier string at the start of every binary trajectory file.
+		static const char Format_id[8];
+
+		//! The current version of the binary trajectory format.
+		static const int32_t Format_version = 1;
+
+		~Trajectory_Recorder();
+
+		//! \brief Creates the trajectory file and writes the header.
+		//! \param filename is the name of the trajectory file.
+		//! \param buffer_size is the number of records that are buffered before they are written to the file.
+		//! \return true if the file was created successfully and false otherwise.
+		bool open(const std::string& filename, const int buffer_size);
+
+		//! \brief Writes any buffered records to the file and closes it.
+		void close();
+
+		//! \brief Adds a record to the buffer, writing the buffer to the file first if it is full.
+		void addRecord(const double time, const int tag, const uint8_t species, const long int site_index, const uint8_t event_type, const double energy) {
+			if (N_buffered == buffer.size()) {
+				flush();
+			}
+			Trajectory_Record& record = buffer[N_buffered++];
+			record.time = time;
+			record.energy = energy;
+			record.site_index = site_index;
+			record.tag = tag;
+			record.species = species;
+			record.event_type = event_type;
+		}
+
+		//! \brief Gets the name of the species code.
+		static std::string getSpeciesName(const uint8_t species);
+
+		//! \brief Gets the name of the event type code.
+		static std::string getEventTypeName(const uint8_t event_type);
+
+		//! \brief Reads the header of a binary trajectory file and checks that it can be read.
+		//! \param input is the input stream of the trajectory file, which is left positioned at the first record.
+		//! \param error_message is set to a description of the problem when the file cannot be read.
+		//! \return true if the header is valid and false otherwise.
+		static bool readHeader(std::istream& input, std::string& error_message);
+
+	private:
+		std::ofstream file;
+		std::vector<Trajectory_Record> buffer;
+		size_t N_buffered = 0;
+
+		void flush();
+};
+
+#endif // TRAJECTORY_RECORDER_H
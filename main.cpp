@@ -3,14 +3,22 @@
 // For more information, see the LICENSE file that accompanies this software.
 // The Excimontec project can be found on Github at https://github.com/MikeHeiber/Excimontec
 
+#include "Communicator.h"
 #include "OSC_Sim.h"
-#include <mpi.h>
+#include "Run_Results.h"
+#ifdef EXCIMONTEC_NO_MPI
+#include "Thread_Communicator.h"
+#include <thread>
+#else
+#include "MPI_Communicator.h"
+#endif
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <ctime>
 #include <functional>
+#include <memory>
 
 using namespace std;
 using namespace Utils;
@@ -22,25 +30,71 @@ struct Parameters_main{
     string Morphology_set_format;
     int N_test_morphologies;
     int N_morphology_set_size;
+	bool Enable_shared_morphology;
 	bool Enable_extraction_map_output;
+	int Test_block_size;
+	string Sweep_parameter;
+	vector<double> Sweep_values;
 };
 
 //Declare Functions
+int claimTests(Communicator& comm, const long int N_tests_total, const int block_size);
+int runSimulation(Communicator& comm, const string& parameterfilename);
 bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameters_OPV& params);
+bool parseSweepValues(const string& sweep_values_str, vector<double>& sweep_values);
+void setSweepParameter(Parameters_OPV& params, const string& sweep_parameter, const double value);
 
 int main(int argc, char *argv[]) {
+	string parameterfilename = argv[1];
+#ifdef EXCIMONTEC_NO_MPI
+	// Without MPI, each processor is a thread of this process, and the number of threads is given by the second command line argument
+	int N_threads = (argc > 2) ? atoi(argv[2]) : 1;
+	if (N_threads < 1) {
+		cout << "Error! The number of threads must be at least one." << endl;
+		return 0;
+	}
+	vector<unique_ptr<Thread_Communicator>> comms = Thread_Communicator::create(N_threads);
+	vector<thread> threads;
+	for (auto& comm : comms) {
+		Communicator* comm_ptr = comm.get();
+		threads.push_back(thread([comm_ptr, &parameterfilename] {
+			if (runSimulation(*comm_ptr, parameterfilename) != 0) {
+				comm_ptr->abort();
+			}
+		}));
+	}
+	for (auto& item : threads) {
+		item.join();
+	}
+#else
+	// Initialize mpi options
+	cout << "Initializing MPI options... ";
+	MPI_Init(&argc, &argv);
+	{
+		MPI_Communicator comm(MPI_COMM_WORLD);
+		cout << comm.getRank() << ": MPI initialization complete!" << endl;
+		// An error on only some of the processors ends the whole run, because the other processors would otherwise wait for them
+		if (runSimulation(comm, parameterfilename) != 0) {
+			comm.abort();
+		}
+	}
+	MPI_Finalize();
+#endif
+	return 0;
+}
+
+int runSimulation(Communicator& comm, const string& parameterfilename) {
 	string version = "v1.0-beta.3";
 	// Parameters
 	bool End_sim = false;
 	// File declaration
 	ifstream parameterfile;
-	ifstream morphologyfile;
 	ofstream logfile;
+	Trajectory_Recorder trajectory_recorder;
 	ofstream resultsfile;
 	ofstream analysisfile;
 	stringstream ss;
 	// Initialize variables
-	string parameterfilename;
 	string logfilename;
 	Parameters_main params_main;
 	Parameters_OPV params_opv;
@@ -49,43 +103,61 @@ int main(int argc, char *argv[]) {
 	int elapsedtime;
 	time_t time_start, time_end;
 	bool success;
-	bool all_finished = false;
-	vector<bool> proc_finished;
 	vector<bool> error_status_vec;
 	vector<string> error_messages;
 	char error_found = (char)0;
+	Morphology_Header morphology_header;
+	vector<unsigned char> morphology_packed_types;
+	// Startup timing
+	double time_morphology_load = 0;
+	double time_morphology_broadcast = 0;
+	double time_initialization = 0;
+	int isMorphologyReader = 0;
+	int selected_morphology = 0;
+	unique_ptr<Communicator> node_morphology_comm;
+	long int N_tests_total = 0;
+	int N_tests_claimed = 0;
 	// Start timer
 	time_start = time(NULL);
 	// Import parameters and options from parameter file and command line arguments
 	cout << "Loading input parameters from file... " << endl;
-	parameterfilename = argv[1];
 	parameterfile.open(parameterfilename.c_str(), ifstream::in);
 	if (!parameterfile.good()) {
 		cout << "Error loading parameter file.  Program will now exit." << endl;
-		return 0;
+		return 1;
 	}
 	success = importParameters(parameterfile, params_main, params_opv);
 	parameterfile.close();
 	if (!success) {
 		cout << "Error importing parameters from parameter file.  Program will now exit." << endl;
-		return 0;
+		return 1;
 	}
 	cout << "Parameter loading complete!" << endl;
-	// Initialize mpi options
-	cout << "Initializing MPI options... ";
-	MPI_Init(&argc, &argv);
-	MPI_Comm_size(MPI_COMM_WORLD, &nproc);
-	MPI_Comm_rank(MPI_COMM_WORLD, &procid);
-	cout << procid << ": MPI initialization complete!" << endl;
+	nproc = comm.getSize();
+	procid = comm.getRank();
 	// Initialize error monitoring vectors
-	proc_finished.assign(nproc, false);
 	error_status_vec.assign(nproc, false);
 	error_messages.assign(nproc, "");
+	// Dynamic test distribution
+	// Procs claim blocks of tests from a shared counter on proc 0 until nproc*N_tests tests have been claimed, so that faster procs perform more of the tests
+	if (params_main.Test_block_size < 0 || params_main.Test_block_size > params_opv.N_tests) {
+		cout << "Error! The test block size must not be negative and must not be greater than the number of tests." << endl;
+		return 1;
+	}
+	if (params_main.Test_block_size > 0 && params_opv.Enable_IQE_test) {
+		cout << "Error! Dynamic test distribution cannot be used with the IQE test." << endl;
+		return 1;
+	}
+	N_tests_claimed = params_opv.N_tests;
+	if (params_main.Test_block_size > 0) {
+		comm.createCounter();
+		N_tests_total = (long int)nproc*params_opv.N_tests;
+	}
 	// Morphology set import handling
 	if (params_main.Enable_import_morphology_set && params_main.N_test_morphologies > nproc) {
 		cout << "Error! The number of requested processors cannot be less than the number of morphologies tested." << endl;
 		cout << "You have requested " << nproc << " processors for " << params_main.N_test_morphologies << " morphologies." << endl;
-		return 0;
+		return 1;
 	}
 	if (params_main.Enable_import_morphology_set) {
 		int* selected_morphologies = (int *)malloc(sizeof(int)*nproc);
@@ -114,167 +186,353 @@ int main(int argc, char *argv[]) {
 				morphology_set.pop_back();
 			}
 		}
-		MPI_Barrier(MPI_COMM_WORLD);
-		MPI_Bcast(selected_morphologies, nproc, MPI_INT, 0, MPI_COMM_WORLD);
+		comm.barrier();
+		comm.broadcast(selected_morphologies, sizeof(int)*nproc, 0);
 		// Parse input morphology set file format
 		int pos = (int)params_main.Morphology_set_format.find("#");
 		string prefix = params_main.Morphology_set_format.substr(0, pos);
 		string suffix = params_main.Morphology_set_format.substr(pos + 1);
-		cout << procid << ": Morphology " << selected_morphologies[procid] << " selected." << endl;
+		selected_morphology = selected_morphologies[procid];
+		cout << procid << ": Morphology " << selected_morphology << " selected." << endl;
 		ss << prefix << selected_morphologies[procid] << suffix;
 		cout << procid << ": " << ss.str() << " selected." << endl;
 		params_main.Morphology_filename = ss.str();
 		ss.str("");
 	}
+	// Morphology import handling
+	// Each distinct morphology file is loaded once by the lowest ranked processor that selected it, and the bit-packed site types
+	// are broadcast to the other processors that selected the same morphology.
 	if (params_main.Enable_import_morphology_single || params_main.Enable_import_morphology_set) {
 		params_opv.Enable_import_morphology = true;
-		morphologyfile.open(params_main.Morphology_filename.c_str(), ifstream::in);
-		if (morphologyfile.good()) {
-			params_opv.Morphology_file = &morphologyfile;
+		params_opv.Morphology_filename = params_main.Morphology_filename;
+		params_opv.Morphology_file = nullptr;
+		unique_ptr<Communicator> morphology_comm = comm.split(selected_morphology);
+		int morphology_rank = morphology_comm->getRank();
+		int load_status = 1;
+		unsigned long long packed_size = 0;
+		if (morphology_rank == 0) {
+			double time_load_start = comm.getWallTime();
+			string error_message;
+			if (!Morphology::loadMorphology(params_main.Morphology_filename, morphology_header, morphology_packed_types, error_message)) {
+				cout << procid << ": Error importing morphology file " << params_main.Morphology_filename << ": " << error_message << endl;
+				load_status = 0;
+			}
+			packed_size = morphology_packed_types.size();
+			time_morphology_load = comm.getWallTime() - time_load_start;
+			isMorphologyReader = 1;
 		}
-		else {
+		double time_broadcast_start = comm.getWallTime();
+		morphology_comm->broadcast(&load_status, sizeof(int), 0);
+		if (load_status == 0) {
 			cout << procid << ": Error opening morphology file for importing." << endl;
-			return 0;
+			return 1;
+		}
+		morphology_comm->broadcast(&morphology_header, sizeof(Morphology_Header), 0);
+		morphology_comm->broadcast(&packed_size, sizeof(unsigned long long), 0);
+		morphology_packed_types.resize((size_t)packed_size);
+		morphology_comm->broadcast(morphology_packed_types.data(), (size_t)packed_size, 0);
+		time_morphology_broadcast = comm.getWallTime() - time_broadcast_start;
+		morphology_comm.reset();
+		params_opv.Morphology_header = &morphology_header;
+		params_opv.Morphology_packed_types = morphology_packed_types.data();
+		// Processors on the same node that selected the same morphology can share a single read-only copy of the unpacked site types
+		if (params_main.Enable_shared_morphology) {
+			node_morphology_comm = comm.splitShared(selected_morphology);
+			long int N_sites = (long int)morphology_header.length*morphology_header.width*morphology_header.height;
+			// The site types are unpacked by the node leader and are visible to the other processors once the shared array has been created
+			params_opv.Shared_site_types = node_morphology_comm->createSharedArray((size_t)N_sites, [&](unsigned char* shared_site_types) {
+				for (long int n = 0; n < N_sites; n++) {
+					shared_site_types[n] = (unsigned char)Morphology::getPackedType(morphology_packed_types.data(), morphology_header.bits_per_site, n);
+				}
+			});
 		}
 	}
 	else {
 		params_opv.Enable_import_morphology = false;
 	}
-	// Setup file output
-	cout << procid << ": Creating output files..." << endl;
-	if (params_opv.Enable_logging) {
-		ss << "log" << procid << ".txt";
-		logfilename = ss.str();
-		logfile.open(ss.str().c_str());
-		ss.str("");
-	}
 	params_opv.Logfile = &logfile;
-	// Initialize Simulation
-	cout << procid << ": Initializing simulation " << procid << "..." << endl;
-	OSC_Sim sim;
-	success = sim.init(params_opv, procid);
-	if (!success) {
-		cout << procid << ": Initialization failed, simulation will now terminate." << endl;
-		return 0;
+	// Parameter sweep handling
+	// Each sweep point is simulated in sequence by all procs, and each new simulation reuses the morphology and interface data of the previous one,
+	// as well as its site energies unless the energetic disorder is swept.  Without a sweep, the loop performs a single simulation.
+	const bool Enable_sweep = (params_main.Sweep_parameter.compare("none") != 0);
+	vector<double> sweep_values = Enable_sweep ? params_main.Sweep_values : vector<double>(1, 0.0);
+	ofstream sweepfile;
+	if (Enable_sweep && procid == 0) {
+		sweepfile.open("sweep_results.txt");
+		sweepfile << "Sweep Point," << params_main.Sweep_parameter << ",Initialization Time (s)";
+		if (params_opv.Enable_exciton_diffusion_test) {
+			sweepfile << ",Excitons Tested,Diffusion Length (nm),Diffusion Length Stdev (nm)";
+		}
+		else if (params_opv.Enable_ToF_test) {
+			sweepfile << ",Transit Attempts,Polarons Collected,Transit Time (s),Transit Time Stdev (s),Mobility (cm^2 V^-1 s^-1),Mobility Stdev (cm^2 V^-1 s^-1)";
+		}
+		else if (params_opv.Enable_dynamics_test || params_opv.Enable_IQE_test) {
+			sweepfile << ",Excitons Created,Excitons Dissociated (%),Singlets Recombined (%),Triplets Recombined (%),Charges Extracted (%)";
+			if (params_opv.Enable_IQE_test) {
+				sweepfile << ",IQE (%)";
+			}
+		}
+		sweepfile << endl;
 	}
-	cout << procid << ": Simulation initialization complete" << endl;
-	if (params_opv.Enable_exciton_diffusion_test) {
-		cout << procid << ": Starting exciton diffusion test..." << endl;
-	}
-	else if (params_opv.Enable_dynamics_test) {
-		cout << procid << ": Starting dynamics test..." << endl;
-	}
-	else if (params_opv.Enable_ToF_test) {
-		cout << procid << ": Starting time-of-flight charge transport test..." << endl;
-	}
-	else if (params_opv.Enable_IQE_test) {
-		cout << procid << ": Starting internal quantum efficiency test..." << endl;
-	}
-	// Begin Simulation loop
-	// Simulation ends for all procs with procid >0 when End_sim is true
-	// Proc 0 only ends when End_sim is true and all_finished is true
-	while (!End_sim || (procid == 0 && !all_finished)) {
-		if (!End_sim) {
-			success = sim.executeNextEvent();
-			if (!success) {
-				cout << procid << ": Event execution failed, simulation will now terminate." << endl;
-			}
-			End_sim = sim.checkFinished();
-		}
-		// Check for errors
-		if (!success || sim.getN_events_executed() % 500000 == 0 || End_sim) {
-			// Send completion status, error status, message length, and message content to proc 0
-			char finished_status;
-			char error_status;
-			char msg_length;
-			for (int i = 1; i < nproc; i++) {
-				// Send status messages to proc 0
-				if (procid == i) {
-					finished_status = End_sim ? (char)1 : (char)0;
-					error_status = !success ? (char)1 : (char)0;
-					MPI_Send(&error_status, 1, MPI_CHAR, 0, i, MPI_COMM_WORLD);
-					// If the proc has an error, send the error message to proc 0
-					if (!success) {
-						msg_length = (char)sim.getErrorMessage().size();
-						MPI_Send(&msg_length, 1, MPI_CHAR, 0, i, MPI_COMM_WORLD);
-						MPI_Send(sim.getErrorMessage().c_str(), (int)msg_length, MPI_CHAR, 0, i, MPI_COMM_WORLD);
+	unique_ptr<OSC_Sim> sim_ptr;
+	Run_Results results;
+	Run_Results combined;
+	int sweep_index_last = 0;
+	for (int sweep_index = 0; sweep_index < (int)sweep_values.size(); sweep_index++) {
+		sweep_index_last = sweep_index;
+		End_sim = false;
+		if (Enable_sweep) {
+			setSweepParameter(params_opv, params_main.Sweep_parameter, sweep_values[sweep_index]);
+			cout << procid << ": Starting sweep point " << sweep_index << " with " << params_main.Sweep_parameter << " = " << sweep_values[sweep_index] << "." << endl;
+		}
+		// Setup file output
+		// Each sweep point has its own log and trajectory files, because the object tags of each new simulation start again from zero
+		cout << procid << ": Creating output files..." << endl;
+		string file_suffix = "";
+		if (Enable_sweep) {
+			ss << "_sweep" << sweep_index;
+			file_suffix = ss.str();
+			ss.str("");
+		}
+		if (params_opv.Enable_logging) {
+			ss << "log" << procid << file_suffix << ".txt";
+			logfilename = ss.str();
+			logfile.close();
+			logfile.open(ss.str().c_str());
+			ss.str("");
+		}
+		if (params_opv.Enable_trajectory_recording) {
+			ss << "trajectory" << procid << file_suffix << ".bin";
+			if (!trajectory_recorder.open(ss.str(), 65536)) {
+				cout << procid << ": Error creating trajectory file " << ss.str() << "." << endl;
+				return 1;
+			}
+			ss.str("");
+			params_opv.Trajectory_recorder = &trajectory_recorder;
+		}
+		if (params_main.Test_block_size > 0) {
+			// All tests of the previous sweep point have been claimed once all procs have finished, so the shared counter can be reset
+			if (sweep_index > 0) {
+				comm.resetCounter();
+			}
+			// The first block is always complete because the block size is not greater than N_tests
+			N_tests_claimed = claimTests(comm, N_tests_total, params_main.Test_block_size);
+			params_opv.N_tests = N_tests_claimed;
+		}
+		// Initialize Simulation
+		// The simulation of the previous sweep point is kept until the new simulation has copied its lattice data
+		cout << procid << ": Initializing simulation " << procid << "..." << endl;
+		unique_ptr<OSC_Sim> sim_new(new OSC_Sim());
+		params_opv.Previous_sim = sim_ptr.get();
+		params_opv.Enable_site_energy_reuse = (params_main.Sweep_parameter.compare("Energy_stdev") != 0);
+		double time_init_start = comm.getWallTime();
+		success = sim_new->init(params_opv, procid);
+		time_initialization = comm.getWallTime() - time_init_start;
+		sim_ptr = move(sim_new);
+		OSC_Sim& sim = *sim_ptr;
+		// The packed morphology data is no longer needed once the site types have been assigned, and later sweep points copy the site types instead
+		vector<unsigned char>().swap(morphology_packed_types);
+		params_opv.Morphology_header = nullptr;
+		params_opv.Morphology_packed_types = nullptr;
+		if (!success) {
+			cout << procid << ": Initialization failed, simulation will now terminate." << endl;
+			return 1;
+		}
+		cout << procid << ": Simulation initialization complete" << endl;
+		if (params_opv.Enable_exciton_diffusion_test) {
+			cout << procid << ": Starting exciton diffusion test..." << endl;
+		}
+		else if (params_opv.Enable_dynamics_test) {
+			cout << procid << ": Starting dynamics test..." << endl;
+		}
+		else if (params_opv.Enable_ToF_test) {
+			cout << procid << ": Starting time-of-flight charge transport test..." << endl;
+		}
+		else if (params_opv.Enable_IQE_test) {
+			cout << procid << ": Starting internal quantum efficiency test..." << endl;
+		}
+		// Begin Simulation loop
+		// The error and completion status of all procs is combined with non-blocking reductions, so procs that are still simulating only test for completion
+		// Each reduction sums the number of procs with errors and the number of finished procs, and all procs end after the same reduction
+		int status_local[2] = { 0, 0 };
+		int status_global[2] = { 0, 0 };
+		long int N_events_next_status = 500000;
+		while (true) {
+			if (!End_sim) {
+				success = sim.executeNextEvent();
+				if (!success) {
+					cout << procid << ": Event execution failed, simulation will now terminate." << endl;
+				}
+				End_sim = !success || sim.checkFinished();
+				// Claim more tests when the current tests are finished
+				if (End_sim && success && params_main.Test_block_size > 0) {
+					int N_tests_new = claimTests(comm, N_tests_total, params_main.Test_block_size);
+					if (N_tests_new > 0) {
+						N_tests_claimed += N_tests_new;
+						sim.addTests(N_tests_new);
+						End_sim = false;
 					}
-					MPI_Send(&finished_status, 1, MPI_CHAR, 0, i, MPI_COMM_WORLD);
 				}
-				// Receive messages from any processors not previously finished
-				if (procid == 0 && !proc_finished[i]) {
-					// Receive error status message
-					MPI_Recv(&error_status, 1, MPI_CHAR, i, i, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-					error_status_vec[i] = (error_status == (char)1) ? true : false;
-					// If the proc has an error, then receive the error message
-					if (error_status_vec[i]) {
-						MPI_Recv(&msg_length, 1, MPI_CHAR, i, i, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-						char* error_msg = (char *)malloc(sizeof(char) * (int)msg_length);
-						MPI_Recv(error_msg, (int)msg_length, MPI_CHAR, i, i, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-						error_messages[i] = string(error_msg);
-						error_found = (char)1;
+				// Output status
+				if (sim.getN_events_executed() % 1000000 == 0) {
+					sim.outputStatus();
+				}
+				// Reset logfile
+				if (params_opv.Enable_logging) {
+					if (sim.getN_events_executed() % 1000 == 0) {
+						logfile.close();
+						logfile.open(logfilename.c_str());
 					}
-					MPI_Recv(&finished_status, 1, MPI_CHAR, i, i, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-					proc_finished[i] = (finished_status == (char)1) ? true : false;
 				}
 			}
-			// Check error status of proc 0
-			if (!success) {
-				error_found = (char)1;
-			}
-			// Send error status from proc 0 to all unfinished procs
-			for (int i = 1; i < nproc; i++) {
-				if (procid == 0) {
-					MPI_Send(&error_found, 1, MPI_CHAR, i, i, MPI_COMM_WORLD);
+			// Check the result of the pending status reduction, procs that are no longer simulating wait for it to complete
+			if (comm.isSumPending() && (End_sim || sim.getN_events_executed() % 1000 == 0)) {
+				bool status_ready = false;
+				if (End_sim) {
+					comm.waitSum();
+					status_ready = true;
 				}
-				if (procid == i && !proc_finished[i]) {
-					MPI_Recv(&error_found, 1, MPI_CHAR, 0, i, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+				else {
+					status_ready = comm.testSum();
+				}
+				if (status_ready && (status_global[0] > 0 || status_global[1] == nproc)) {
+					break;
 				}
 			}
-			// Update info for proc 0
-			error_status_vec[0] = !success;
-			proc_finished[0] = End_sim;
-			error_messages[0] = sim.getErrorMessage();
-			if (error_found == (char)1) {
-				break;
+			// Start the next status reduction
+			if (!comm.isSumPending() && (End_sim || sim.getN_events_executed() >= N_events_next_status)) {
+				status_local[0] = success ? 0 : 1;
+				status_local[1] = End_sim ? 1 : 0;
+				comm.startSum(status_local, status_global, 2);
+				N_events_next_status = sim.getN_events_executed() + 500000;
 			}
-			// Update completion status
+		}
+		// Error messages are only gathered when an error occured on one or more procs
+		if (status_global[0] > 0) {
+			error_found = (char)1;
+			vector<int> error_status_all = comm.gather(success ? 0 : 1, 0);
+			vector<string> error_messages_all = comm.gather(success ? string() : sim.getErrorMessage(), 0);
 			if (procid == 0) {
-				all_finished = true;
 				for (int i = 0; i < nproc; i++) {
-					if (!proc_finished[i]) {
-						all_finished = false;
-						break;
-					}
+					error_status_vec[i] = (error_status_all[i] == 1);
+					error_messages[i] = error_messages_all[i];
 				}
 			}
-			// Output status
-			if (sim.getN_events_executed() % 1000000 == 0) {
-				sim.outputStatus();
+		}
+		time_end = time(NULL);
+		elapsedtime = (int)difftime(time_end, time_start);
+		// Collect the results of this processor, which back both the results file and the analysis summary
+		results = Run_Results();
+		results.setCounter(Run_Results::Elapsed_time, (double)elapsedtime);
+		results.setCounter(Run_Results::Morphology_load_time, time_morphology_load);
+		results.setCounter(Run_Results::Morphology_broadcast_time, time_morphology_broadcast);
+		results.setCounter(Run_Results::Initialization_time, time_initialization);
+		results.setCounter(Run_Results::Morphology_readers, (double)isMorphologyReader);
+		results.setCounter(Run_Results::N_transient_cycles, (double)sim.getN_transient_cycles());
+		results.setCounter(Run_Results::Transit_attempts, (double)((!params_opv.ToF_polaron_type) ? sim.getN_electrons_created() : sim.getN_holes_created()));
+		results.setCounter(Run_Results::Polarons_collected, (double)((!params_opv.ToF_polaron_type) ? sim.getN_electrons_collected() : sim.getN_holes_collected()));
+		results.setCounter(Run_Results::Excitons_tested, (double)(sim.getN_singlet_excitons_recombined() + sim.getN_triplet_excitons_recombined()));
+		results.setCounter(Run_Results::Excitons_created, (double)sim.getN_excitons_created());
+		results.setCounter(Run_Results::Excitons_created_donor, (double)sim.getN_excitons_created((short)1));
+		results.setCounter(Run_Results::Excitons_created_acceptor, (double)sim.getN_excitons_created((short)2));
+		results.setCounter(Run_Results::Excitons_dissociated, (double)sim.getN_excitons_dissociated());
+		results.setCounter(Run_Results::Singlet_excitons_recombined, (double)sim.getN_singlet_excitons_recombined());
+		results.setCounter(Run_Results::Triplet_excitons_recombined, (double)sim.getN_triplet_excitons_recombined());
+		results.setCounter(Run_Results::Singlet_singlet_annihilations, (double)sim.getN_singlet_singlet_annihilations());
+		results.setCounter(Run_Results::Singlet_triplet_annihilations, (double)sim.getN_singlet_triplet_annihilations());
+		results.setCounter(Run_Results::Triplet_triplet_annihilations, (double)sim.getN_triplet_triplet_annihilations());
+		results.setCounter(Run_Results::Singlet_polaron_annihilations, (double)sim.getN_singlet_polaron_annihilations());
+		results.setCounter(Run_Results::Triplet_polaron_annihilations, (double)sim.getN_triplet_polaron_annihilations());
+		results.setCounter(Run_Results::Geminate_recombinations, (double)sim.getN_geminate_recombinations());
+		results.setCounter(Run_Results::Bimolecular_recombinations, (double)sim.getN_bimolecular_recombinations());
+		results.setCounter(Run_Results::Electrons_collected, (double)sim.getN_electrons_collected());
+		results.setCounter(Run_Results::Holes_collected, (double)sim.getN_holes_collected());
+		if (params_opv.Enable_ToF_test) {
+			results.setDataVector(Run_Results::ToF_transient_counts, sim.getToFTransientCounts());
+			results.setDataVector(Run_Results::ToF_transient_energies, sim.getToFTransientEnergies());
+			results.setDataVector(Run_Results::ToF_transient_velocities, sim.getToFTransientVelocities());
+		}
+		if (params_opv.Enable_dynamics_test) {
+			results.setDataVector(Run_Results::Dynamics_transient_singlets, sim.getDynamicsTransientSinglets());
+			results.setDataVector(Run_Results::Dynamics_transient_triplets, sim.getDynamicsTransientTriplets());
+			results.setDataVector(Run_Results::Dynamics_transient_electrons, sim.getDynamicsTransientElectrons());
+			results.setDataVector(Run_Results::Dynamics_transient_holes, sim.getDynamicsTransientHoles());
+			results.setDataVector(Run_Results::Dynamics_exciton_energies, sim.getDynamicsExcitonEnergies());
+			results.setDataVector(Run_Results::Dynamics_electron_energies, sim.getDynamicsElectronEnergies());
+			results.setDataVector(Run_Results::Dynamics_hole_energies, sim.getDynamicsHoleEnergies());
+			results.setDataVector(Run_Results::Dynamics_exciton_msdv, sim.getDynamicsExcitonMSDV());
+			results.setDataVector(Run_Results::Dynamics_electron_msdv, sim.getDynamicsElectronMSDV());
+			results.setDataVector(Run_Results::Dynamics_hole_msdv, sim.getDynamicsHoleMSDV());
+		}
+		vector<double> tests_claimed(nproc, 0.0);
+		tests_claimed[procid] = (double)N_tests_claimed;
+		results.setDataVector(Run_Results::Tests_claimed, tests_claimed);
+		results.setStatistics(Run_Results::Diffusion_lengths, sim.getDiffusionStats());
+		results.setStatistics(Run_Results::Transit_times, sim.getTransitTimeStats());
+		results.setStatistics(Run_Results::Mobilities, sim.getMobilityStats());
+		// All counters, data vectors, and sample statistics are combined with a single reduction
+		combined = results.combine(comm);
+		if (Enable_sweep && procid == 0 && error_found == (char)0) {
+			sweepfile << sweep_index << "," << sweep_values[sweep_index] << "," << combined.getCounter(Run_Results::Initialization_time) / nproc;
+			if (params_opv.Enable_exciton_diffusion_test) {
+				const Sample_Statistics& diffusion_stats = combined.getStatistics(Run_Results::Diffusion_lengths);
+				sweepfile << "," << combined.getCount(Run_Results::Excitons_tested) << "," << diffusion_stats.getMean() << "," << diffusion_stats.getStdev();
+			}
+			else if (params_opv.Enable_ToF_test) {
+				const Sample_Statistics& transit_time_stats = combined.getStatistics(Run_Results::Transit_times);
+				const Sample_Statistics& mobility_stats = combined.getStatistics(Run_Results::Mobilities);
+				sweepfile << "," << combined.getCount(Run_Results::Transit_attempts) << "," << combined.getCount(Run_Results::Polarons_collected);
+				sweepfile << "," << transit_time_stats.getMean() << "," << transit_time_stats.getStdev() << "," << mobility_stats.getMean() << "," << mobility_stats.getStdev();
 			}
-			// Reset logfile
-			if (params_opv.Enable_logging) {
-				if (sim.getN_events_executed() % 1000 == 0) {
-					logfile.close();
-					logfile.open(logfilename.c_str());
+			else if (params_opv.Enable_dynamics_test || params_opv.Enable_IQE_test) {
+				double excitons_created = combined.getCounter(Run_Results::Excitons_created);
+				sweepfile << "," << combined.getCount(Run_Results::Excitons_created) << "," << 100 * combined.getCounter(Run_Results::Excitons_dissociated) / excitons_created;
+				sweepfile << "," << 100 * combined.getCounter(Run_Results::Singlet_excitons_recombined) / excitons_created << "," << 100 * combined.getCounter(Run_Results::Triplet_excitons_recombined) / excitons_created;
+				sweepfile << "," << 100 * (double)(combined.getCount(Run_Results::Electrons_collected) + combined.getCount(Run_Results::Holes_collected)) / (2 * combined.getCounter(Run_Results::Excitons_dissociated));
+				if (params_opv.Enable_IQE_test) {
+					sweepfile << "," << 100 * (double)(combined.getCount(Run_Results::Electrons_collected) + combined.getCount(Run_Results::Holes_collected)) / (2 * excitons_created);
 				}
 			}
+			sweepfile << endl;
 		}
+		// The remaining sweep points are skipped when an error occured
+		if (error_found == (char)1) {
+			break;
+		}
+	}
+	if (procid == 0) {
+		sweepfile.close();
 	}
+	OSC_Sim& sim = *sim_ptr;
 	if (params_opv.Enable_logging) {
 		logfile.close();
 	}
+	trajectory_recorder.close();
+	if (params_main.Test_block_size > 0) {
+		comm.freeCounter();
+	}
 	cout << procid << ": Simulation finished." << endl;
-	time_end = time(NULL);
-	elapsedtime = (int)difftime(time_end, time_start);
 	// Output result summary for each processor
 	ss << "results" << procid << ".txt";
 	resultsfile.open(ss.str().c_str());
 	ss.str("");
 	resultsfile << "Excimontec " << version << " Results:\n";
-	resultsfile << "Calculation time elapsed is " << (double)elapsedtime / 60 << " minutes.\n";
+	// The elapsed time is measured from the start of the run, so with a sweep it covers all sweep points
+	if (Enable_sweep) {
+		resultsfile << "Total calculation time elapsed for all sweep points is " << results.getCounter(Run_Results::Elapsed_time) / 60 << " minutes.\n";
+	}
+	else {
+		resultsfile << "Calculation time elapsed is " << results.getCounter(Run_Results::Elapsed_time) / 60 << " minutes.\n";
+	}
 	resultsfile << sim.getTime() << " seconds have been simulated.\n";
 	resultsfile << sim.getN_events_executed() << " events have been executed.\n";
+	if (params_main.Test_block_size > 0) {
+		resultsfile << (int)results.getDataVector(Run_Results::Tests_claimed)[procid] << " tests were claimed by this processor.\n";
+	}
+	if (sim.getN_sites((short)1) > 0 && sim.getN_sites((short)2) > 0) {
+		resultsfile << "The donor/acceptor interfacial area is " << sim.getInterfacialArea() << " nm^2, giving an interfacial area to volume ratio of " << sim.getInterfacialArea() / (params_opv.Length*params_opv.Width*params_opv.Height*intpow(params_opv.Unit_size, 3)) << " nm^-1.\n";
+		resultsfile << 100 * (double)sim.getN_interface_sites((short)1) / (double)sim.getN_sites((short)1) << "% of donor sites and " << 100 * (double)sim.getN_interface_sites((short)2) / (double)sim.getN_sites((short)2) << "% of acceptor sites are within the exciton dissociation cutoff of the interface.\n";
+	}
 	if (!success) {
 		resultsfile << "An error occured during the simulation:" << endl;
 		resultsfile << sim.getErrorMessage() << endl;
@@ -282,45 +540,45 @@ int main(int argc, char *argv[]) {
 	else {
 		if (params_opv.Enable_exciton_diffusion_test) {
 			resultsfile << "Exciton diffusion test results:\n";
-			resultsfile << sim.getN_excitons_created() << " excitons have been created.\n";
-			resultsfile << "Exciton Diffusion Length is " << sim.calculateDiffusionLength_avg() << "  " << sim.calculateDiffusionLength_stdev() << " nm.\n";
+			resultsfile << results.getCount(Run_Results::Excitons_created) << " excitons have been created.\n";
+			resultsfile << "Exciton Diffusion Length is " << results.getStatistics(Run_Results::Diffusion_lengths).getMean() << "  " << results.getStatistics(Run_Results::Diffusion_lengths).getStdev() << " nm.\n";
 		}
 		else if (params_opv.Enable_ToF_test) {
 			resultsfile << "Time-of-flight charge transport test results:\n";
 			if (!params_opv.ToF_polaron_type) {
-				resultsfile << sim.getN_electrons_collected() << " of " << sim.getN_electrons_created() << " electrons have been collected.\n";
+				resultsfile << results.getCount(Run_Results::Electrons_collected) << " of " << results.getCount(Run_Results::Transit_attempts) << " electrons have been collected.\n";
 			}
 			else {
-				resultsfile << sim.getN_holes_collected() << " of " << sim.getN_holes_created() << " holes have been collected.\n";
+				resultsfile << results.getCount(Run_Results::Holes_collected) << " of " << results.getCount(Run_Results::Transit_attempts) << " holes have been collected.\n";
 			}
-			resultsfile << "Transit time is " << sim.calculateTransitTime_avg() << "  " << sim.calculateTransitTime_stdev() << " s.\n";
-			resultsfile << "Charge carrier mobility is " << sim.calculateMobility_avg() << "  " << sim.calculateMobility_stdev() << " cm^2 V^-1 s^-1.\n";
+			resultsfile << "Transit time is " << results.getStatistics(Run_Results::Transit_times).getMean() << "  " << results.getStatistics(Run_Results::Transit_times).getStdev() << " s.\n";
+			resultsfile << "Charge carrier mobility is " << results.getStatistics(Run_Results::Mobilities).getMean() << "  " << results.getStatistics(Run_Results::Mobilities).getStdev() << " cm^2 V^-1 s^-1.\n";
 		}
 		if (params_opv.Enable_dynamics_test) {
 			resultsfile << "Dynamics test results:\n";
-			resultsfile << sim.getN_excitons_created() << " initial excitons were created.\n";
+			resultsfile << results.getCount(Run_Results::Excitons_created) << " initial excitons were created.\n";
 		}
 		if (params_opv.Enable_IQE_test) {
 			resultsfile << "Internal quantum efficiency test results:\n";
-			resultsfile << sim.getN_excitons_created() << " excitons have been created.\n";
+			resultsfile << results.getCount(Run_Results::Excitons_created) << " excitons have been created.\n";
 		}
 		if (params_opv.Enable_IQE_test || params_opv.Enable_dynamics_test) {
-			resultsfile << sim.getN_excitons_created((short)1) << " excitons were created on donor sites.\n";
-			resultsfile << sim.getN_excitons_created((short)2) << " excitons were created on acceptor sites.\n";
-			resultsfile << 100 * (double)sim.getN_excitons_dissociated() / (double)sim.getN_excitons_created() << "% of excitons have dissociated.\n";
-			resultsfile << 100 * (double)sim.getN_singlet_excitons_recombined() / (double)sim.getN_excitons_created() << "% of excitons relaxed to the ground state as singlets.\n";
-			resultsfile << 100 * (double)sim.getN_triplet_excitons_recombined() / (double)sim.getN_excitons_created() << "% of excitons relaxed to the ground state as triplets.\n";
-			resultsfile << 100 * (double)sim.getN_singlet_singlet_annihilations() / (double)sim.getN_excitons_created() << "% of excitons were lost to singlet-singlet annihilation.\n";
-			resultsfile << 100 * (double)sim.getN_singlet_triplet_annihilations() / (double)sim.getN_excitons_created() << "% of excitons were lost to singlet-triplet annihilation.\n";
-			resultsfile << 100 * (double)sim.getN_triplet_triplet_annihilations() / (double)sim.getN_excitons_created() << "% of excitons were lost to triplet-triplet annihilation.\n";
-			resultsfile << 100 * (double)sim.getN_singlet_polaron_annihilations() / (double)sim.getN_excitons_created() << "% of excitons were lost to singlet-polaron annihilation.\n";
-			resultsfile << 100 * (double)sim.getN_triplet_polaron_annihilations() / (double)sim.getN_excitons_created() << "% of excitons were lost to triplet-polaron annihilation.\n";
-			resultsfile << 100 * (double)sim.getN_geminate_recombinations() / (double)sim.getN_excitons_dissociated() << "% of photogenerated charges were lost to geminate recombination.\n";
-			resultsfile << 100 * (double)sim.getN_bimolecular_recombinations() / (double)sim.getN_excitons_dissociated() << "% of photogenerated charges were lost to bimolecular recombination.\n";
-			resultsfile << 100 * (double)(sim.getN_electrons_collected() + sim.getN_holes_collected()) / (2 * (double)sim.getN_excitons_dissociated()) << "% of photogenerated charges were extracted.\n";
+			resultsfile << results.getCount(Run_Results::Excitons_created_donor) << " excitons were created on donor sites.\n";
+			resultsfile << results.getCount(Run_Results::Excitons_created_acceptor) << " excitons were created on acceptor sites.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Excitons_dissociated) / results.getCounter(Run_Results::Excitons_created) << "% of excitons have dissociated.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Singlet_excitons_recombined) / results.getCounter(Run_Results::Excitons_created) << "% of excitons relaxed to the ground state as singlets.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Triplet_excitons_recombined) / results.getCounter(Run_Results::Excitons_created) << "% of excitons relaxed to the ground state as triplets.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Singlet_singlet_annihilations) / results.getCounter(Run_Results::Excitons_created) << "% of excitons were lost to singlet-singlet annihilation.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Singlet_triplet_annihilations) / results.getCounter(Run_Results::Excitons_created) << "% of excitons were lost to singlet-triplet annihilation.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Triplet_triplet_annihilations) / results.getCounter(Run_Results::Excitons_created) << "% of excitons were lost to triplet-triplet annihilation.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Singlet_polaron_annihilations) / results.getCounter(Run_Results::Excitons_created) << "% of excitons were lost to singlet-polaron annihilation.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Triplet_polaron_annihilations) / results.getCounter(Run_Results::Excitons_created) << "% of excitons were lost to triplet-polaron annihilation.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Geminate_recombinations) / results.getCounter(Run_Results::Excitons_dissociated) << "% of photogenerated charges were lost to geminate recombination.\n";
+			resultsfile << 100 * results.getCounter(Run_Results::Bimolecular_recombinations) / results.getCounter(Run_Results::Excitons_dissociated) << "% of photogenerated charges were lost to bimolecular recombination.\n";
+			resultsfile << 100 * (double)(results.getCount(Run_Results::Electrons_collected) + results.getCount(Run_Results::Holes_collected)) / (2 * results.getCounter(Run_Results::Excitons_dissociated)) << "% of photogenerated charges were extracted.\n";
 		}
 		if (params_opv.Enable_IQE_test) {
-			resultsfile << "IQE = " << 100 * (double)(sim.getN_electrons_collected() + sim.getN_holes_collected()) / (2 * (double)sim.getN_excitons_created()) << "% with an internal potential of " << params_opv.Internal_potential << " V." << endl;
+			resultsfile << "IQE = " << 100 * (double)(results.getCount(Run_Results::Electrons_collected) + results.getCount(Run_Results::Holes_collected)) / (2 * results.getCounter(Run_Results::Excitons_created)) << "% with an internal potential of " << params_opv.Internal_potential << " V." << endl;
 		}
 		resultsfile << endl;
 	}
@@ -347,16 +605,53 @@ int main(int argc, char *argv[]) {
 			outputVectorToFile(extraction_data, filename);
 		}
 	}
+	// Output raw data samples
+	if (success && params_opv.Raw_data_sample_size > 0 && (params_opv.Enable_exciton_diffusion_test || params_opv.Enable_ToF_test)) {
+		if (params_opv.Enable_exciton_diffusion_test) {
+			ss << "Diffusion_length_samples" << procid << ".txt";
+			string filename = ss.str();
+			ss.str("");
+			vector<double> samples = sim.getDiffusionStats().getReservoir();
+			outputVectorToFile(samples, filename);
+		}
+		if (params_opv.Enable_ToF_test) {
+			ss << "Transit_time_samples" << procid << ".txt";
+			string filename = ss.str();
+			ss.str("");
+			vector<double> samples = sim.getTransitTimeStats().getReservoir();
+			outputVectorToFile(samples, filename);
+		}
+	}
 	// Output overall analysis results from all processors
-	int elapsedtime_sum;
-	MPI_Reduce(&elapsedtime, &elapsedtime_sum, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
 	if (procid == 0) {
 		ss << "analysis_summary.txt";
 		analysisfile.open(ss.str().c_str());
 		ss.str("");
 		analysisfile << "Excimontec " << version << " Results Summary:\n";
 		analysisfile << "Simulation was performed on " << nproc << " processors.\n";
-		analysisfile << "Average calculation time was " << (double)elapsedtime_sum / (60 * nproc) << " minutes.\n";
+		if (Enable_sweep) {
+			analysisfile << "A sweep of " << params_main.Sweep_parameter << " was performed over " << sweep_values.size() << " points, and the results of each point are in sweep_results.txt.\n";
+			analysisfile << "Average total calculation time for all sweep points was " << combined.getCounter(Run_Results::Elapsed_time) / (60 * nproc) << " minutes.\n";
+			analysisfile << "The following results are for the last simulated sweep point with " << params_main.Sweep_parameter << " = " << sweep_values[sweep_index_last] << ".\n";
+		}
+		else {
+			analysisfile << "Average calculation time was " << combined.getCounter(Run_Results::Elapsed_time) / (60 * nproc) << " minutes.\n";
+		}
+		analysisfile << "Startup time breakdown:\n";
+		if (params_opv.Enable_import_morphology) {
+			int N_readers = combined.getCount(Run_Results::Morphology_readers);
+			double load_time_avg = combined.getCounter(Run_Results::Morphology_load_time) / N_readers;
+			analysisfile << N_readers << " distinct morphology files were each loaded once, taking " << load_time_avg << " seconds on average.\n";
+			analysisfile << "Distributing the packed morphology data took " << combined.getCounter(Run_Results::Morphology_broadcast_time) / nproc << " seconds on average.\n";
+			analysisfile << "Loading on one processor per morphology avoided an estimated " << (nproc - N_readers)*load_time_avg << " seconds of total file I/O and parsing time.\n";
+		}
+		analysisfile << "Simulation initialization took " << combined.getCounter(Run_Results::Initialization_time) / nproc << " seconds on average.\n";
+		if (params_main.Test_block_size > 0) {
+			analysisfile << "Tests were dynamically distributed in blocks of " << params_main.Test_block_size << " tests, and the number of tests claimed by each processor was:\n";
+			for (int i = 0; i < nproc; i++) {
+				analysisfile << i << ": " << (int)combined.getDataVector(Run_Results::Tests_claimed)[i] << "\n";
+			}
+		}
 		if (error_found == (char)1) {
 			analysisfile << endl << "An error occured on one or more processors:" << endl;
 			for (int i = 0; i < nproc; i++) {
@@ -366,219 +661,174 @@ int main(int argc, char *argv[]) {
 			}
 		}
 	}
-	if (error_found == (char)0 && params_opv.Enable_exciton_diffusion_test) {
-		vector<double> diffusion_data;
-		diffusion_data = MPI_gatherVectors(sim.getDiffusionData());
-		if (procid == 0) {
-			analysisfile << "Overall exciton diffusion test results:\n";
-			analysisfile << nproc*(sim.getN_singlet_excitons_recombined() + sim.getN_triplet_excitons_recombined()) << " total excitons tested." << endl;
-			analysisfile << "Exciton diffusion length is " << vector_avg(diffusion_data) << "  " << vector_stdev(diffusion_data) << " nm.\n";
-		}
-	}
-	if (error_found == (char)0 && params_opv.Enable_ToF_test) {
-		int N_transient_cycles = sim.getN_transient_cycles();
-		int N_transient_cycles_sum;
-		MPI_Reduce(&N_transient_cycles, &N_transient_cycles_sum, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		vector<double> transit_times = MPI_gatherVectors(sim.getTransitTimeData());
-		int transit_attempts = ((sim.getN_electrons_collected() > sim.getN_holes_collected()) ? sim.getN_electrons_created() : (sim.getN_holes_created()));
-		int transit_attempts_total;
-		MPI_Reduce(&transit_attempts, &transit_attempts_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		vector<int> counts = MPI_calculateVectorSum(sim.getToFTransientCounts());
-		vector<double> energies = MPI_calculateVectorSum(sim.getToFTransientEnergies());
-		vector<double> velocities = MPI_calculateVectorSum(sim.getToFTransientVelocities());
+	if (procid == 0 && error_found == (char)0 && params_opv.Enable_exciton_diffusion_test) {
+		const Sample_Statistics& diffusion_stats = combined.getStatistics(Run_Results::Diffusion_lengths);
+		analysisfile << "Overall exciton diffusion test results:\n";
+		analysisfile << combined.getCount(Run_Results::Excitons_tested) << " total excitons tested." << endl;
+		analysisfile << "Exciton diffusion length is " << diffusion_stats.getMean() << "  " << diffusion_stats.getStdev() << " nm.\n";
+	}
+	if (procid == 0 && error_found == (char)0 && params_opv.Enable_ToF_test) {
+		int N_transient_cycles_sum = combined.getCount(Run_Results::N_transient_cycles);
+		const Sample_Statistics& transit_time_stats = combined.getStatistics(Run_Results::Transit_times);
+		const Sample_Statistics& mobility_stats = combined.getStatistics(Run_Results::Mobilities);
+		int transit_attempts_total = combined.getCount(Run_Results::Transit_attempts);
+		const vector<double>& counts = combined.getDataVector(Run_Results::ToF_transient_counts);
+		const vector<double>& energies = combined.getDataVector(Run_Results::ToF_transient_energies);
+		const vector<double>& velocities = combined.getDataVector(Run_Results::ToF_transient_velocities);
 		vector<double> times = sim.getToFTransientTimes();
-		if (procid == 0) {
-			// ToF main results output
-			vector<double> mobilities = sim.calculateMobilities(transit_times);
-			double electric_field = fabs(sim.getInternalField());
-			ofstream tof_resultsfile;
-			ss << "ToF_results.txt";
-			tof_resultsfile.open(ss.str().c_str());
-			ss.str("");
-			tof_resultsfile << "Electric Field (V/cm),Transit Time Avg (s),Transit Time Stdev (s),Mobility Avg (cm^2 V^-1 s^-1),Mobility Stdev (cm^2 V^-1 s^-1)" << endl;
-			tof_resultsfile << electric_field << "," << vector_avg(transit_times) << "," << vector_stdev(transit_times) << "," << vector_avg(mobilities) << "," << vector_stdev(mobilities) << endl;
-			tof_resultsfile.close();
-			// ToF transient output
-			ofstream transientfile;
-			ss << "ToF_average_transients.txt";
-			transientfile.open(ss.str().c_str());
-			ss.str("");
-			transientfile << "Time (s),Current (mA cm^-2),Average Mobility (cm^2 V^-1 s^-1),Average Energy (eV),Carrier Density (cm^-3)" << endl;
-			double volume_total = N_transient_cycles_sum*sim.getVolume();
-			for (int i = 0; i < (int)velocities.size(); i++) {
-				if (counts[i] > 0 && counts[i] > 5 * N_transient_cycles_sum) {
-					transientfile << times[i] << "," << 1000.0 * Elementary_charge*velocities[i] / volume_total << "," << (velocities[i] / (double)counts[i]) / electric_field << "," << energies[i] / (double)counts[i] << "," << (double)counts[i] / volume_total << endl;
-				}
-				else if (counts[i] > 0) {
-					transientfile << times[i] << "," << 1000.0 * Elementary_charge*velocities[i] / volume_total << "," << (velocities[i] / (double)counts[i]) / electric_field << "," << "NaN" << "," << (double)counts[i] / volume_total << endl;
-				}
-				else {
-					transientfile << times[i] << ",0,NaN,NaN,0" << endl;
-				}
+		// ToF main results output
+		double electric_field = fabs(sim.getInternalField());
+		ofstream tof_resultsfile;
+		ss << "ToF_results.txt";
+		tof_resultsfile.open(ss.str().c_str());
+		ss.str("");
+		tof_resultsfile << "Electric Field (V/cm),Transit Time Avg (s),Transit Time Stdev (s),Mobility Avg (cm^2 V^-1 s^-1),Mobility Stdev (cm^2 V^-1 s^-1)" << endl;
+		tof_resultsfile << electric_field << "," << transit_time_stats.getMean() << "," << transit_time_stats.getStdev() << "," << mobility_stats.getMean() << "," << mobility_stats.getStdev() << endl;
+		tof_resultsfile.close();
+		// ToF transient output
+		ofstream transientfile;
+		ss << "ToF_average_transients.txt";
+		transientfile.open(ss.str().c_str());
+		ss.str("");
+		transientfile << "Time (s),Current (mA cm^-2),Average Mobility (cm^2 V^-1 s^-1),Average Energy (eV),Carrier Density (cm^-3)" << endl;
+		double volume_total = N_transient_cycles_sum*sim.getVolume();
+		for (int i = 0; i < (int)velocities.size(); i++) {
+			if (counts[i] > 0 && counts[i] > 5 * N_transient_cycles_sum) {
+				transientfile << times[i] << "," << 1000.0 * Elementary_charge*velocities[i] / volume_total << "," << (velocities[i] / (double)counts[i]) / electric_field << "," << energies[i] / (double)counts[i] << "," << (double)counts[i] / volume_total << endl;
 			}
-			transientfile.close();
-			// ToF transit time distribution output
-			ofstream transitdistfile;
-			ss << "ToF_transit_time_dist.txt";
-			transitdistfile.open(ss.str().c_str());
-			ss.str("");
-			vector<double> transit_dist = sim.calculateTransitTimeDist(transit_times, transit_attempts_total);
-			transitdistfile << "Transit Time (s),Probability" << endl;
-			for (int i = 0; i < (int)transit_dist.size(); i++) {
-				transitdistfile << times[i] << "," << transit_dist[i] << endl;
-			}
-			transitdistfile.close();
-			// Analysis Output
-			if (!params_opv.ToF_polaron_type) {
-				analysisfile << nproc*sim.getN_electrons_collected() << " total electrons collected out of " << transit_attempts_total << " total attempts.\n";
+			else if (counts[i] > 0) {
+				transientfile << times[i] << "," << 1000.0 * Elementary_charge*velocities[i] / volume_total << "," << (velocities[i] / (double)counts[i]) / electric_field << "," << "NaN" << "," << (double)counts[i] / volume_total << endl;
 			}
 			else {
-				analysisfile << nproc*sim.getN_holes_collected() << " total holes collected out of " << transit_attempts_total << " total attempts.\n";
+				transientfile << times[i] << ",0,NaN,NaN,0" << endl;
 			}
-			analysisfile << "Overall time-of-flight charge transport test results:\n";
-			analysisfile << "Transit time is " << vector_avg(transit_times) << "  " << vector_stdev(transit_times) << " s.\n";
-			analysisfile << "Charge carrier mobility is " << vector_avg(mobilities) << "  " << vector_stdev(mobilities) << " cm^2 V^-1 s^-1.\n";
 		}
+		transientfile.close();
+		// ToF transit time distribution output
+		ofstream transitdistfile;
+		ss << "ToF_transit_time_dist.txt";
+		transitdistfile.open(ss.str().c_str());
+		ss.str("");
+		vector<double> transit_dist = transit_time_stats.getHistogram();
+		for (auto& item : transit_dist) {
+			item /= transit_attempts_total;
+		}
+		transitdistfile << "Transit Time (s),Probability" << endl;
+		for (int i = 0; i < (int)transit_dist.size(); i++) {
+			transitdistfile << times[i] << "," << transit_dist[i] << endl;
+		}
+		transitdistfile.close();
+		// Analysis Output
+		if (!params_opv.ToF_polaron_type) {
+			analysisfile << combined.getCount(Run_Results::Polarons_collected) << " total electrons collected out of " << transit_attempts_total << " total attempts.\n";
+		}
+		else {
+			analysisfile << combined.getCount(Run_Results::Polarons_collected) << " total holes collected out of " << transit_attempts_total << " total attempts.\n";
+		}
+		analysisfile << "Overall time-of-flight charge transport test results:\n";
+		analysisfile << "Transit time is " << transit_time_stats.getMean() << "  " << transit_time_stats.getStdev() << " s.\n";
+		analysisfile << "Charge carrier mobility is " << mobility_stats.getMean() << "  " << mobility_stats.getStdev() << " cm^2 V^-1 s^-1.\n";
 	}
-	if (error_found == (char)0 && params_opv.Enable_dynamics_test) {
-		int N_transient_cycles = sim.getN_transient_cycles();
-		int N_transient_cycles_sum;
-		MPI_Reduce(&N_transient_cycles, &N_transient_cycles_sum, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+	if (procid == 0 && error_found == (char)0 && params_opv.Enable_dynamics_test) {
+		int N_transient_cycles_sum = combined.getCount(Run_Results::N_transient_cycles);
 		vector<double> times = sim.getDynamicsTransientTimes();
-		vector<int> singlets_total = MPI_calculateVectorSum(sim.getDynamicsTransientSinglets());
-		vector<int> triplets_total = MPI_calculateVectorSum(sim.getDynamicsTransientTriplets());
-		vector<int> electrons_total = MPI_calculateVectorSum(sim.getDynamicsTransientElectrons());
-		vector<int> holes_total = MPI_calculateVectorSum(sim.getDynamicsTransientHoles());
-		vector<double> exciton_energies = MPI_calculateVectorSum(sim.getDynamicsExcitonEnergies());
-		vector<double> electron_energies = MPI_calculateVectorSum(sim.getDynamicsElectronEnergies());
-		vector<double> hole_energies = MPI_calculateVectorSum(sim.getDynamicsHoleEnergies());
-		vector<double> exciton_msdv = MPI_calculateVectorSum(sim.getDynamicsExcitonMSDV());
-		vector<double> electron_msdv = MPI_calculateVectorSum(sim.getDynamicsElectronMSDV());
-		vector<double> hole_msdv = MPI_calculateVectorSum(sim.getDynamicsHoleMSDV());
-		if (procid == 0) {
-			ofstream transientfile;
-			ss << "dynamics_average_transients.txt";
-			transientfile.open(ss.str().c_str());
-			ss.str("");
-			transientfile << "Time (s),Singlet Exciton Density (cm^-3),Triplet Exciton Density (cm^-3),Electron Density (cm^-3),Hole Density (cm^-3)";
-			transientfile << ",Average Exciton Energy (eV),Exciton MSDV (cm^2 s^-1)";
-			transientfile << ",Average Electron Energy (eV),Electron MSDV (cm^2 s^-1)";
-			transientfile << ",Average Hole Energy (eV),Hole MSDV (cm^2 s^-1)" << endl;
-			double volume_total = N_transient_cycles_sum*sim.getVolume();
-			for (int i = 0; i < (int)times.size(); i++) {
-				transientfile << times[i] << "," << singlets_total[i] / volume_total << "," << triplets_total[i] / volume_total << "," << electrons_total[i] / volume_total << "," << holes_total[i] / volume_total;
-				if ((singlets_total[i] + triplets_total[i]) > 0 && (singlets_total[i] + triplets_total[i]) > 5 * N_transient_cycles_sum) {
-					transientfile << "," << exciton_energies[i] / (singlets_total[i] + triplets_total[i]) << "," << exciton_msdv[i] / (singlets_total[i] + triplets_total[i]);
-				}
-				else if ((singlets_total[i] + triplets_total[i]) > 0 ) {
-					transientfile << "," << "NaN" << "," << exciton_msdv[i] / (singlets_total[i] + triplets_total[i]);
-				}
-				else {
-					transientfile << ",NaN,NaN";
-				}
-				if (electrons_total[i] > 0 && electrons_total[i] > 5 * N_transient_cycles_sum) {
-					transientfile << "," << electron_energies[i] / electrons_total[i] << "," << electron_msdv[i] / electrons_total[i];
-				}
-				else if (electrons_total[i] > 0) {
-					transientfile << "," << "NaN" << "," << electron_msdv[i] / electrons_total[i];
-				}
-				else {
-					transientfile << ",NaN,NaN";
-				}
-				if (holes_total[i] > 0 && holes_total[i] > 5 * N_transient_cycles_sum) {
-					transientfile << "," << hole_energies[i] / holes_total[i] << "," << hole_msdv[i] / holes_total[i] << endl;
-				}
-				else if (holes_total[i] > 0) {
-					transientfile << "," << "NaN" << "," << hole_msdv[i] / holes_total[i] << endl;
-				}
-				else {
-					transientfile << ",NaN,NaN" << endl;
-					//transientfile << ",NaN" << endl;
-				}
+		const vector<double>& singlets_total = combined.getDataVector(Run_Results::Dynamics_transient_singlets);
+		const vector<double>& triplets_total = combined.getDataVector(Run_Results::Dynamics_transient_triplets);
+		const vector<double>& electrons_total = combined.getDataVector(Run_Results::Dynamics_transient_electrons);
+		const vector<double>& holes_total = combined.getDataVector(Run_Results::Dynamics_transient_holes);
+		const vector<double>& exciton_energies = combined.getDataVector(Run_Results::Dynamics_exciton_energies);
+		const vector<double>& electron_energies = combined.getDataVector(Run_Results::Dynamics_electron_energies);
+		const vector<double>& hole_energies = combined.getDataVector(Run_Results::Dynamics_hole_energies);
+		const vector<double>& exciton_msdv = combined.getDataVector(Run_Results::Dynamics_exciton_msdv);
+		const vector<double>& electron_msdv = combined.getDataVector(Run_Results::Dynamics_electron_msdv);
+		const vector<double>& hole_msdv = combined.getDataVector(Run_Results::Dynamics_hole_msdv);
+		ofstream transientfile;
+		ss << "dynamics_average_transients.txt";
+		transientfile.open(ss.str().c_str());
+		ss.str("");
+		transientfile << "Time (s),Singlet Exciton Density (cm^-3),Triplet Exciton Density (cm^-3),Electron Density (cm^-3),Hole Density (cm^-3)";
+		transientfile << ",Average Exciton Energy (eV),Exciton MSDV (cm^2 s^-1)";
+		transientfile << ",Average Electron Energy (eV),Electron MSDV (cm^2 s^-1)";
+		transientfile << ",Average Hole Energy (eV),Hole MSDV (cm^2 s^-1)" << endl;
+		double volume_total = N_transient_cycles_sum*sim.getVolume();
+		for (int i = 0; i < (int)times.size(); i++) {
+			transientfile << times[i] << "," << singlets_total[i] / volume_total << "," << triplets_total[i] / volume_total << "," << electrons_total[i] / volume_total << "," << holes_total[i] / volume_total;
+			if ((singlets_total[i] + triplets_total[i]) > 0 && (singlets_total[i] + triplets_total[i]) > 5 * N_transient_cycles_sum) {
+				transientfile << "," << exciton_energies[i] / (singlets_total[i] + triplets_total[i]) << "," << exciton_msdv[i] / (singlets_total[i] + triplets_total[i]);
+			}
+			else if ((singlets_total[i] + triplets_total[i]) > 0 ) {
+				transientfile << "," << "NaN" << "," << exciton_msdv[i] / (singlets_total[i] + triplets_total[i]);
+			}
+			else {
+				transientfile << ",NaN,NaN";
+			}
+			if (electrons_total[i] > 0 && electrons_total[i] > 5 * N_transient_cycles_sum) {
+				transientfile << "," << electron_energies[i] / electrons_total[i] << "," << electron_msdv[i] / electrons_total[i];
+			}
+			else if (electrons_total[i] > 0) {
+				transientfile << "," << "NaN" << "," << electron_msdv[i] / electrons_total[i];
 			}
-			transientfile.close();
-		}
-	}
-	if (error_found == (char)0 && (params_opv.Enable_dynamics_test || params_opv.Enable_IQE_test)) {
-		int excitons_created = sim.getN_excitons_created();
-		int excitons_created_total;
-		MPI_Reduce(&excitons_created, &excitons_created_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int excitons_created_donor = sim.getN_excitons_created((short)1);
-		int excitons_created_donor_total;
-		MPI_Reduce(&excitons_created_donor, &excitons_created_donor_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int excitons_created_acceptor = sim.getN_excitons_created((short)2);
-		int excitons_created_acceptor_total;
-		MPI_Reduce(&excitons_created_acceptor, &excitons_created_acceptor_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int excitons_dissociated = sim.getN_excitons_dissociated();
-		int excitons_dissociated_total;
-		MPI_Reduce(&excitons_dissociated, &excitons_dissociated_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int singlet_excitons_recombined = sim.getN_singlet_excitons_recombined();
-		int singlet_excitons_recombined_total;
-		MPI_Reduce(&singlet_excitons_recombined, &singlet_excitons_recombined_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int triplet_excitons_recombined = sim.getN_triplet_excitons_recombined();
-		int triplet_excitons_recombined_total;
-		MPI_Reduce(&triplet_excitons_recombined, &triplet_excitons_recombined_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int singlet_singlet_annihilations = sim.getN_singlet_singlet_annihilations();
-		int singlet_singlet_annihilations_total;
-		MPI_Reduce(&singlet_singlet_annihilations, &singlet_singlet_annihilations_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int singlet_triplet_annihilations = sim.getN_singlet_triplet_annihilations();
-		int singlet_triplet_annihilations_total;
-		MPI_Reduce(&singlet_triplet_annihilations, &singlet_triplet_annihilations_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int triplet_triplet_annihilations = sim.getN_triplet_triplet_annihilations();
-		int triplet_triplet_annihilations_total;
-		MPI_Reduce(&triplet_triplet_annihilations, &triplet_triplet_annihilations_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int singlet_polaron_annihilations = sim.getN_singlet_polaron_annihilations();
-		int singlet_polaron_annihilations_total;
-		MPI_Reduce(&singlet_polaron_annihilations, &singlet_polaron_annihilations_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int triplet_polaron_annihilations = sim.getN_triplet_polaron_annihilations();
-		int triplet_polaron_annihilations_total;
-		MPI_Reduce(&triplet_polaron_annihilations, &triplet_polaron_annihilations_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int geminate_recombinations = sim.getN_geminate_recombinations();
-		int geminate_recombinations_total;
-		MPI_Reduce(&geminate_recombinations, &geminate_recombinations_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int bimolecular_recombinations = sim.getN_bimolecular_recombinations();
-		int bimolecular_recombinations_total;
-		MPI_Reduce(&bimolecular_recombinations, &bimolecular_recombinations_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int electrons_collected = sim.getN_electrons_collected();
-		int electrons_collected_total;
-		MPI_Reduce(&electrons_collected, &electrons_collected_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		int holes_collected = sim.getN_holes_collected();
-		int holes_collected_total;
-		MPI_Reduce(&holes_collected, &holes_collected_total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-		if (procid == 0 && params_opv.Enable_dynamics_test) {
+			else {
+				transientfile << ",NaN,NaN";
+			}
+			if (holes_total[i] > 0 && holes_total[i] > 5 * N_transient_cycles_sum) {
+				transientfile << "," << hole_energies[i] / holes_total[i] << "," << hole_msdv[i] / holes_total[i] << endl;
+			}
+			else if (holes_total[i] > 0) {
+				transientfile << "," << "NaN" << "," << hole_msdv[i] / holes_total[i] << endl;
+			}
+			else {
+				transientfile << ",NaN,NaN" << endl;
+				//transientfile << ",NaN" << endl;
+			}
+		}
+		transientfile.close();
+	}
+	if (procid == 0 && error_found == (char)0 && (params_opv.Enable_dynamics_test || params_opv.Enable_IQE_test)) {
+		if (params_opv.Enable_dynamics_test) {
 			analysisfile << "Overall dynamics test results:\n";
 		}
-		if (procid == 0 && params_opv.Enable_IQE_test) {
+		if (params_opv.Enable_IQE_test) {
 			analysisfile << "Overall internal quantum efficiency test results:\n";
 		}
-		if (procid == 0) {
-			analysisfile << excitons_created_total << " total excitons have been created.\n";
-			analysisfile << excitons_created_donor_total << " excitons were created on donor sites.\n";
-			analysisfile << excitons_created_acceptor_total << " excitons were created on acceptor sites.\n";
-			analysisfile << 100 * (double)excitons_dissociated_total / (double)excitons_created_total << "% of total excitons have dissociated.\n";
-			analysisfile << 100 * (double)singlet_excitons_recombined_total / (double)excitons_created_total << "% of total excitons relaxed to the ground state as singlets.\n";
-			analysisfile << 100 * (double)triplet_excitons_recombined_total / (double)excitons_created_total << "% of total excitons relaxed to the ground state as triplets.\n";
-			analysisfile << 100 * (double)singlet_singlet_annihilations_total / (double)excitons_created_total << "% of total excitons were lost to singlet-singlet annihilation.\n";
-			analysisfile << 100 * (double)singlet_triplet_annihilations_total / (double)excitons_created_total << "% of total excitons were lost to singlet-triplet annihilation.\n";
-			analysisfile << 100 * (double)triplet_triplet_annihilations_total / (double)excitons_created_total << "% of total excitons were lost to triplet-triplet annihilation.\n";
-			analysisfile << 100 * (double)singlet_polaron_annihilations_total / (double)excitons_created_total << "% of total excitons were lost to singlet-polaron annihilation.\n";
-			analysisfile << 100 * (double)triplet_polaron_annihilations_total / (double)excitons_created_total << "% of total excitons were lost to triplet-polaron annihilation.\n";
-			analysisfile << 100 * (double)geminate_recombinations_total / (double)excitons_dissociated_total << "% of total photogenerated charges were lost to geminate recombination.\n";
-			analysisfile << 100 * (double)bimolecular_recombinations_total / (double)excitons_dissociated_total << "% of total photogenerated charges were lost to bimolecular recombination.\n";
-			analysisfile << 100 * (double)(electrons_collected_total + holes_collected_total) / (2 * (double)excitons_dissociated_total) << "% of total photogenerated charges were extracted.\n";
-		}
-		if (procid == 0 && params_opv.Enable_IQE_test) {
-			analysisfile << "IQE = " << 100 * (double)(electrons_collected_total + holes_collected_total) / (2 * (double)excitons_created_total) << "% with an internal potential of " << params_opv.Internal_potential << " V." << endl;
+		analysisfile << combined.getCount(Run_Results::Excitons_created) << " total excitons have been created.\n";
+		analysisfile << combined.getCount(Run_Results::Excitons_created_donor) << " excitons were created on donor sites.\n";
+		analysisfile << combined.getCount(Run_Results::Excitons_created_acceptor) << " excitons were created on acceptor sites.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Excitons_dissociated) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons have dissociated.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Singlet_excitons_recombined) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons relaxed to the ground state as singlets.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Triplet_excitons_recombined) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons relaxed to the ground state as triplets.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Singlet_singlet_annihilations) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons were lost to singlet-singlet annihilation.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Singlet_triplet_annihilations) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons were lost to singlet-triplet annihilation.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Triplet_triplet_annihilations) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons were lost to triplet-triplet annihilation.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Singlet_polaron_annihilations) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons were lost to singlet-polaron annihilation.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Triplet_polaron_annihilations) / combined.getCounter(Run_Results::Excitons_created) << "% of total excitons were lost to triplet-polaron annihilation.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Geminate_recombinations) / combined.getCounter(Run_Results::Excitons_dissociated) << "% of total photogenerated charges were lost to geminate recombination.\n";
+		analysisfile << 100 * combined.getCounter(Run_Results::Bimolecular_recombinations) / combined.getCounter(Run_Results::Excitons_dissociated) << "% of total photogenerated charges were lost to bimolecular recombination.\n";
+		analysisfile << 100 * (double)(combined.getCount(Run_Results::Electrons_collected) + combined.getCount(Run_Results::Holes_collected)) / (2 * combined.getCounter(Run_Results::Excitons_dissociated)) << "% of total photogenerated charges were extracted.\n";
+		if (params_opv.Enable_IQE_test) {
+			analysisfile << "IQE = " << 100 * (double)(combined.getCount(Run_Results::Electrons_collected) + combined.getCount(Run_Results::Holes_collected)) / (2 * combined.getCounter(Run_Results::Excitons_created)) << "% with an internal potential of " << params_opv.Internal_potential << " V." << endl;
 		}
 	}
 	if (procid == 0) {
 		analysisfile.close();
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Finalize();
+	comm.barrier();
+	if (node_morphology_comm) {
+		node_morphology_comm->freeSharedArrays();
+	}
 	return 0;
 }
 
+int claimTests(Communicator& comm, const long int N_tests_total, const int block_size) {
+	// Atomically add a block to the number of claimed tests and receive the previous number of claimed tests
+	long int increment = block_size;
+	long int N_claimed_prev = comm.fetchAndAddCounter(increment);
+	if (N_claimed_prev >= N_tests_total) {
+		return 0;
+	}
+	return (int)min(increment, N_tests_total - N_claimed_prev);
+}
+
 bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameters_OPV& params){
     string line;
     string var;
@@ -650,6 +900,8 @@ bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameter
     i++;
 	params.Internal_potential = atof(stringvars[i].c_str());
 	i++;
+	params.N_threads = atoi(stringvars[i].c_str());
+	i++;
     // Film Architecture Parameters
     params.Enable_neat = importBooleanParam(stringvars[i],error_status);
     if(error_status){
@@ -675,6 +927,18 @@ bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameter
     i++;
     params.Acceptor_conc = atof(stringvars[i].c_str());;
     i++;
+    params.Enable_ising_blend = importBooleanParam(stringvars[i],error_status);
+    if(error_status){
+        cout << "Error enabling Ising blend film architecture." << endl;
+        return false;
+    }
+    i++;
+    params.Ising_interaction_energy = atof(stringvars[i].c_str());
+    i++;
+    params.Ising_MC_steps = atoi(stringvars[i].c_str());
+    i++;
+    params.Ising_smoothing_threshold = atof(stringvars[i].c_str());
+    i++;
     params_main.Enable_import_morphology_single = importBooleanParam(stringvars[i],error_status);
     if(error_status){
         cout << "Error enabling morphology import." << endl;
@@ -695,9 +959,30 @@ bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameter
     i++;
     params_main.N_morphology_set_size = atoi(stringvars[i].c_str());
     i++;
+	params_main.Enable_shared_morphology = importBooleanParam(stringvars[i], error_status);
+	if (error_status) {
+		cout << "Error enabling shared morphology memory." << endl;
+		return false;
+	}
+	i++;
     // Test Parameters
     params.N_tests = atoi(stringvars[i].c_str());
     i++;
+	params_main.Test_block_size = atoi(stringvars[i].c_str());
+	i++;
+	params_main.Sweep_parameter = stringvars[i];
+	if (!(params_main.Sweep_parameter.compare("none") == 0 || params_main.Sweep_parameter.compare("Temperature") == 0 || params_main.Sweep_parameter.compare("Internal_potential") == 0
+		|| params_main.Sweep_parameter.compare("Polaron_localization") == 0 || params_main.Sweep_parameter.compare("Energy_stdev") == 0)) {
+		cout << "Error setting the sweep parameter. " << params_main.Sweep_parameter << " is not a valid sweep parameter." << endl;
+		return false;
+	}
+	i++;
+	// Sweep values are only used when a sweep parameter is set
+	if (params_main.Sweep_parameter.compare("none") != 0 && !parseSweepValues(stringvars[i], params_main.Sweep_values)) {
+		cout << "Error setting the sweep values. " << stringvars[i] << " is not a valid list or range of values." << endl;
+		return false;
+	}
+	i++;
     params.Enable_exciton_diffusion_test = importBooleanParam(stringvars[i],error_status);
     if(error_status){
         cout << "Error enabling the exciton diffusion test." << endl;
@@ -743,6 +1028,46 @@ bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameter
 		return false;
 	}
 	i++;
+	params.Raw_data_sample_size = atoi(stringvars[i].c_str());
+	i++;
+	params.Enable_trajectory_recording = importBooleanParam(stringvars[i], error_status);
+	if (error_status) {
+		cout << "Error enabling trajectory recording." << endl;
+		return false;
+	}
+	i++;
+	// Trajectory species are given as "all" or a comma separated list of singlet, triplet, electron, and hole
+	params.Trajectory_species_mask = 0;
+	if (stringvars[i].compare("all") == 0) {
+		params.Trajectory_species_mask = (1 << Trajectory_Recorder::Singlet) | (1 << Trajectory_Recorder::Triplet) | (1 << Trajectory_Recorder::Electron) | (1 << Trajectory_Recorder::Hole);
+	}
+	else {
+		stringstream species_stream(stringvars[i]);
+		string species;
+		while (getline(species_stream, species, ',')) {
+			if (species.compare("singlet") == 0) {
+				params.Trajectory_species_mask |= 1 << Trajectory_Recorder::Singlet;
+			}
+			else if (species.compare("triplet") == 0) {
+				params.Trajectory_species_mask |= 1 << Trajectory_Recorder::Triplet;
+			}
+			else if (species.compare("electron") == 0) {
+				params.Trajectory_species_mask |= 1 << Trajectory_Recorder::Electron;
+			}
+			else if (species.compare("hole") == 0) {
+				params.Trajectory_species_mask |= 1 << Trajectory_Recorder::Hole;
+			}
+			else {
+				cout << "Error setting the trajectory species. " << species << " is not a valid species." << endl;
+				return false;
+			}
+		}
+	}
+	i++;
+	params.Trajectory_sampling_stride = atoi(stringvars[i].c_str());
+	i++;
+	params.Trajectory_sampling_probability = atof(stringvars[i].c_str());
+	i++;
     params.Enable_dynamics_test = importBooleanParam(stringvars[i],error_status);
     if(error_status){
         cout << "Error enabling the dynamics test." << endl;
@@ -904,6 +1229,13 @@ bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameter
     i++;
     params.Energy_urbach_acceptor = atof(stringvars[i].c_str());
     i++;
+	//enable_procedural_dos
+	params.Enable_procedural_dos = importBooleanParam(stringvars[i], error_status);
+	if (error_status) {
+		cout << "Error setting procedural DOS options" << endl;
+		return false;
+	}
+	i++;
 	//enable_correlated_disorder
 	params.Enable_correlated_disorder = importBooleanParam(stringvars[i], error_status);
 	if (error_status) {
@@ -929,6 +1261,13 @@ bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameter
 	i++;
 	params.Power_kernel_exponent = atoi(stringvars[i].c_str());
 	i++;
+	//enable_direct_convolution
+	params.Enable_direct_convolution = importBooleanParam(stringvars[i], error_status);
+	if (error_status) {
+		cout << "Error setting Correlated Disorder direct convolution options" << endl;
+		return false;
+	}
+	i++;
     // Coulomb Calculation Parameters
     params.Dielectric_donor = atof(stringvars[i].c_str());
     i++;
@@ -939,4 +1278,52 @@ bool importParameters(ifstream& inputfile,Parameters_main& params_main,Parameter
     return true;
 }
 
+bool parseSweepValues(const string& sweep_values_str, vector<double>& sweep_values) {
+	// Sweep values are given as a comma separated list or as a start:step:end range that includes the end value
+	sweep_values.clear();
+	stringstream values_stream(sweep_values_str);
+	string value;
+	if (sweep_values_str.find(':') != string::npos) {
+		vector<double> range_values;
+		while (getline(values_stream, value, ':')) {
+			range_values.push_back(atof(value.c_str()));
+		}
+		if (range_values.size() != 3 || range_values[1] == 0 || (range_values[2] - range_values[0]) / range_values[1] < 0) {
+			return false;
+		}
+		// A small tolerance keeps the end value when the range is not exactly divisible by the step due to rounding
+		int N_points = (int)floor((range_values[2] - range_values[0]) / range_values[1] + 1e-6) + 1;
+		for (int n = 0; n < N_points; n++) {
+			sweep_values.push_back(range_values[0] + n*range_values[1]);
+		}
+	}
+	else {
+		while (getline(values_stream, value, ',')) {
+			if (value.empty()) {
+				return false;
+			}
+			sweep_values.push_back(atof(value.c_str()));
+		}
+	}
+	return !sweep_values.empty();
+}
+
+void setSweepParameter(Parameters_OPV& params, const string& sweep_parameter, const double value) {
+	// Swept localization and disorder values are applied to both the donor and the acceptor
+	if (sweep_parameter.compare("Temperature") == 0) {
+		params.Temperature = (int)round(value);
+	}
+	else if (sweep_parameter.compare("Internal_potential") == 0) {
+		params.Internal_potential = value;
+	}
+	else if (sweep_parameter.compare("Polaron_localization") == 0) {
+		params.Polaron_localization_donor = value;
+		params.Polaron_localization_acceptor = value;
+	}
+	else if (sweep_parameter.compare("Energy_stdev") == 0) {
+		params.Energy_stdev_donor = value;
+		params.Energy_stdev_acceptor = value;
+	}
+}
+
 